@@ -0,0 +1,45 @@
+/*
+Library for:				UART logger - DMA driven ring buffer
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32F4 HAL UART DMA driver
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#ifndef KK_LOGGER_H
+#define KK_LOGGER_H
+
+/* Headers */
+
+#include "stm32f4xx_hal.h"
+#include <string.h>
+
+/* General defines */
+
+#define LOGGER_FALSE				0x00
+#define LOGGER_TRUE					0x01
+
+/* Configuration */
+
+#define LOGGER_BAUDRATE				460800		// 0.2 % error from 42 MHz APB1
+#define LOGGER_BUFFER_SIZE			1024		// Power of 2
+
+/* Host commands (single byte on USART2 RX) */
+
+#define LOGGER_CMD_NONE				0x00
+#define LOGGER_CMD_PROFILE			'p'			// Send profiler report
+#define LOGGER_CMD_PROFILE_RESET	'r'			// Clear profiler accumulators
+#define LOGGER_CMD_MEMORY			'm'			// Send RAM usage report
+
+/* Functions */
+
+void LOGGER_init(UART_HandleTypeDef *huart);
+uint8_t LOGGER_write(const void *data, uint16_t len);
+uint32_t LOGGER_getDropped(void);
+uint8_t LOGGER_isIdle(void);
+uint8_t LOGGER_getCommand(void);
+void LOGGER_txCplt(UART_HandleTypeDef *huart);
+void LOGGER_rxCplt(UART_HandleTypeDef *huart);
+void LOGGER_error(UART_HandleTypeDef *huart);
+
+#endif
@@ -0,0 +1,53 @@
+/*
+Library for:				RAM usage - stack high-water mark and heap statistics
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32F446RETX_FLASH.ld memory layout
+							- newlib _sbrk (sysmem.c)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+RAM layout:			| .data .bss | heap (_sbrk) -> | free | <- stack (MSP, interrupts included) | _estack
+
+					Reset_Handler paints everything above .bss with MEMSTAT_PAINT before main.
+					Deepest stack is the lowest word that no longer holds the pattern, searched
+					upwards from the heap top - cost grows with free RAM, so query on demand only.
+
+FreeRTOS build:		Task stacks are static arrays inside .bss (counted in staticSize) and are not
+					painted by Reset_Handler, the MSP numbers above cover interrupts and main before
+					the scheduler started. MEMSTAT_report adds one STACK record per task with the
+					kernel high-water mark (uxTaskGetStackHighWaterMark).
+*/
+
+#ifndef KK_MEMSTAT_H
+#define KK_MEMSTAT_H
+
+/* Headers */
+
+#include "stm32f4xx_hal.h"
+
+/* Configuration */
+
+#define MEMSTAT_PAINT				0xA5A5A5A5	// Keep in sync with Startup/startup_stm32f446retx.s
+
+/* Types */
+
+// All values in bytes
+typedef struct
+{
+	uint32_t staticSize;			// .data + .bss
+	uint32_t heapUsed;				// taken from _sbrk so far, malloc never gives it back
+	uint32_t heapReserved;			// _Min_Heap_Size from linker script
+	uint32_t stackUsed;				// deepest stack since reset
+	uint32_t stackReserved;			// _Min_Stack_Size from linker script
+	uint32_t freeLargest;			// never touched RAM between heap top and deepest stack
+} MEMSTAT_Usage;
+
+/* Functions */
+
+uint32_t MEMSTAT_stackUsed(void);
+void MEMSTAT_get(MEMSTAT_Usage *usage);
+void MEMSTAT_report(void);
+
+#endif
@@ -0,0 +1,24 @@
+/*
+Library for:				Boat motor mixing (speed / direction to H-bridge and PWM)
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32F446RE Reference Manual (TIM1 PWM)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#include "stm32f4xx_hal.h"
+#include "KK_RAMFUNC.h"
+
+#ifndef KK_MOTOR_H
+#define KK_MOTOR_H
+
+/* Binding */
+// Bridge direction - CubeMX labels MOTOR_FWD (PC5) and MOTOR_BWD (PC6) in main.h
+#define MOTOR_PWM_TIM				TIM1
+#define MOTOR_PWM_LEFT				CCR1		// CH1
+#define MOTOR_PWM_RIGHT				CCR2		// CH2
+
+/* Functions */
+void MOTOR_apply(uint8_t speed, uint8_t direction);
+
+#endif /* KK_MOTOR_H */
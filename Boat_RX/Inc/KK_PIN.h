@@ -0,0 +1,46 @@
+/*
+Library for:				Compile-time GPIO binding
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- RM0390 STM32F446xx Reference Manual, 7.4.7 GPIO port bit set/reset register
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:				Drivers name their pins with CubeMX labels from main.h (NRF24_CSN_GPIO_Port and
+					NRF24_CSN_Pin, ...). Port and pin are then constants, so PIN_SET / PIN_RESET
+					compile to one store into BSRR - no HAL_GPIO_WritePin call, no read-modify-write,
+					safe against interrupts touching other pins of the port.
+
+					PIN_ASSERT(port, pin) at file scope rejects a binding that is not one pin of
+					GPIOA - GPIOH, PIN_ASSERT_DISTINCT two bindings sharing a pin. Pointer constants
+					fold in GCC, -pedantic would warn about them.
+*/
+
+#ifndef KK_PIN_H
+#define KK_PIN_H
+
+/* Headers */
+
+#include "stm32f4xx_hal.h"
+
+/* Macros */
+
+#define PIN_SET(port, pin)				((port)->BSRR = (uint32_t)(pin))
+#define PIN_RESET(port, pin)			((port)->BSRR = (uint32_t)(pin) << 16U)
+#define PIN_WRITE(port, pin, state)		((port)->BSRR = (state) ? (uint32_t)(pin) : (uint32_t)(pin) << 16U)
+#define PIN_READ(port, pin)				(((port)->IDR & (pin)) != 0U)
+
+/* Compile-time checks */
+
+#define PIN_IS_SINGLE(pin)				((pin) != 0U && ((pin) & ((pin) - 1U)) == 0U && (pin) <= GPIO_PIN_15)
+#define PIN_IS_PORT(port)				((uintptr_t)(port) >= GPIOA_BASE && (uintptr_t)(port) <= GPIOH_BASE && \
+										 ((uintptr_t)(port) - GPIOA_BASE) % (GPIOB_BASE - GPIOA_BASE) == 0U)
+
+#define PIN_ASSERT(port, pin)			_Static_assert(PIN_IS_PORT(port) && PIN_IS_SINGLE(pin), \
+										#port " / " #pin " is not a single GPIO pin")
+#define PIN_ASSERT_DISTINCT(portA, pinA, portB, pinB) \
+										_Static_assert((uintptr_t)(portA) != (uintptr_t)(portB) || (pinA) != (pinB), \
+										#pinA " and " #pinB " are bound to the same pin")
+
+#endif
@@ -0,0 +1,42 @@
+/*
+Library for:				Execution from SRAM for latency critical code
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32F446RE Reference Manual, 3.4 Read interface (ART accelerator)
+							- stm32f4xx_hal_def.h __RAM_FUNC
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:				RAMFUNC void FOO_bar(void);		// on definition, static functions included
+
+					Code goes to .RamFunc, which the linker script keeps inside .data - Reset_Handler
+					copies it from flash together with initialised variables. Calls between flash and
+					SRAM go through linker veneers, so a RAM function should not call back into flash
+					in its hot loop (HAL, soft-float helpers) or the gain is lost.
+
+					Gain against flash + ART is measured with the Benchmark build: build it once with
+					RAMFUNC_ENABLED=0 and save a baseline (kk_bench -w), then compare the default build
+					against it (kk_bench -c). Tools/footprint/ramfunc.csv lists what has to land in RAM,
+					kk_footprint -r checks it in the map file.
+*/
+
+#ifndef KK_RAMFUNC_H
+#define KK_RAMFUNC_H
+
+/* Configuration */
+
+#ifndef RAMFUNC_ENABLED
+#define RAMFUNC_ENABLED				1
+#endif
+
+/* Macros */
+
+// noinline - inlined copy would run from the caller's flash section
+#if RAMFUNC_ENABLED
+#define RAMFUNC						__attribute__((section(".RamFunc"), noinline))
+#else
+#define RAMFUNC
+#endif
+
+#endif
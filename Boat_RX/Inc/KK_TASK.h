@@ -0,0 +1,235 @@
+/*
+Library for:				Cooperative tasks - stackless protothreads with timer and event waits
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Adam Dunkels, Protothreads: Simplifying Event-Driven Programming
+							  of Memory-Constrained Embedded Systems
+							- PM0214 Cortex-M4 Programming Manual, 3.10.11 WFI
+							- FreeRTOS Reference Manual, static allocation and RTOS on ARM Cortex-M
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:				A task is a function taking TASK_Task *, written straight-line between TASK_BEGIN
+					and TASK_END. TASK_SLEEP / TASK_WAIT_UNTIL / TASK_WAIT_EVENT return from the
+					function and the next call resumes on the same line - the frame is the TASK_Task
+					(16 B), nothing is allocated. Locals do not survive a wait, keep them static.
+					No switch statement may enclose a wait and a line holds one wait at most (the
+					resume point is a case label named after __LINE__).
+
+						static uint8_t radioTask(TASK_Task *t)
+						{
+							TASK_BEGIN(t);
+							for(;;){
+								TASK_CLEAR(radio_irq);
+								NRF24_writeStart(data, PAYLOAD_SIZE);
+								TASK_WAIT_EVENT_TIMEOUT(t, radio_irq, NRF24_TX_TIMEOUT);
+								NRF24_writeFinish();
+								TASK_SLEEP_PERIOD(t, 100);
+							}
+							TASK_END(t);
+						}
+
+					TASK_schedule() runs every task once and sleeps in WFI when all of them wait. Any
+					interrupt wakes the core - SysTick every 1 ms for timed waits, DMA / EXTI callbacks
+					for events. An event signalled between the check and WFI is seen after the next
+					SysTick, so event latency is at most 1 ms. Tasks run in array order, list them
+					from the most urgent one.
+					Timed waits last at least ms - like HAL_Delay they count one tick more, the
+					current one is partly gone (TASK_SLEEP(t, 1) is 1 - 2 ms).
+
+FreeRTOS build:		With USE_FREERTOS the same task functions become preemptive FreeRTOS tasks with
+					the priority given in TASK_INIT - stacks and TCBs are static, no heap. Waits block:
+					TASK_SLEEP is vTaskDelay, TASK_SLEEP_PERIOD vTaskDelayUntil, TASK_WAIT_EVENT and
+					TASK_WAIT_EVENT_TIMEOUT take a binary semaphore given by TASK_signal from the ISR
+					or the producing task. TASK_WAIT_UNTIL and TASK_WAIT_TIMEOUT poll their condition
+					once per tick - keep them for conditions on time (link age), whatever an interrupt
+					or another task can announce waits on a TASK_Event. TASK_start never returns. The kernel is not part of the
+					repository - FreeRTOS-Kernel V10.4 - V11.0 sources (*.c, include/ and
+					portable/GCC/ARM_CM4F, CubeMX layout, no heap_x.c) go to
+					Middlewares/Third_Party/FreeRTOS/Source of each board and the FreeRTOS build
+					configuration compiles them.
+					Main sets all interrupt priorities again for NVIC_PRIORITYGROUP_4 - an ISR calling
+					TASK_signal needs a priority number of configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+					(5) or higher.
+
+Host build:			Define TASK_NOW() and TASK_IDLE() before including the header (gcc -include of a
+					header declaring the simulated clock also covers KK_TASK.c) - no HAL is pulled in
+					and the same tasks run against simulated time. USE_FREERTOS without USE_HAL_DRIVER
+					builds against the FreeRTOS POSIX port (Tools/tasksim).
+*/
+
+#ifndef KK_TASK_H
+#define KK_TASK_H
+
+/* Headers */
+
+#include <stdint.h>
+
+#ifdef USE_FREERTOS
+#ifdef USE_HAL_DRIVER
+#include "stm32f4xx_hal.h"
+#endif
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#else
+
+#ifndef TASK_NOW
+#include "stm32f4xx_hal.h"
+#define TASK_NOW()					HAL_GetTick()
+#endif
+
+#ifndef TASK_IDLE
+#define TASK_IDLE()					__WFI()
+#endif
+
+#endif
+
+/* Configuration */
+
+#ifndef TASK_STACK_SIZE
+#define TASK_STACK_SIZE				256			// words per task, FreeRTOS build only
+#endif
+
+/* Priorities - FreeRTOS build, bare-metal runs tasks in array order */
+
+#define TASK_PRIORITY_TELEMETRY		1
+#define TASK_PRIORITY_DISPLAY		2
+#define TASK_PRIORITY_CONTROL		3
+#define TASK_PRIORITY_RADIO			4
+
+/* Task state returned by a task function */
+
+#define TASK_WAITING				0x00		// blocked on time or event
+#define TASK_YIELDED				0x01		// ready, run again next round
+#define TASK_DONE					0x02		// reached TASK_END, not called again
+
+/* Types */
+
+typedef struct TASK_Task TASK_Task;
+typedef uint8_t (*TASK_Function)(TASK_Task *t);
+
+#ifndef USE_FREERTOS
+
+struct TASK_Task
+{
+	TASK_Function function;
+	uint16_t line;					// resume point, 0 - start
+	uint8_t state;
+	uint8_t priority;
+	uint32_t wake;					// TASK_NOW() deadline of the current sleep
+	uint32_t release;				// start of the current TASK_SLEEP_PERIOD period
+};
+
+// Binary semaphore set from interrupt context, cleared by the waiting task
+typedef volatile uint8_t TASK_Event;
+
+#define TASK_INIT(fn, prio)			{ .function = (fn), .state = TASK_YIELDED, .priority = (prio) }
+
+#else
+
+struct TASK_Task
+{
+	TASK_Function function;
+	const char *name;
+	uint8_t state;
+	uint8_t priority;
+	TickType_t release;
+	TaskHandle_t handle;
+	StaticTask_t tcb;
+	StackType_t stack[TASK_STACK_SIZE];
+};
+
+typedef struct
+{
+	SemaphoreHandle_t handle;
+	StaticSemaphore_t buffer;
+} TASK_Event;
+
+#define TASK_INIT(fn, prio)			{ .function = (fn), .name = #fn, .state = TASK_YIELDED, .priority = (prio) }
+
+#endif
+
+/* Task body */
+
+#ifndef USE_FREERTOS
+
+#define TASK_BEGIN(t)				switch((t)->line){ case 0:
+#define TASK_END(t)					} (t)->line = 0; return TASK_DONE
+
+#define TASK_FALLTHROUGH			__attribute__((fallthrough))
+
+#define TASK_YIELD(t)				do { (t)->line = __LINE__; return TASK_YIELDED; case __LINE__:; } while(0)
+
+#define TASK_WAIT_UNTIL(t, cond)	do { (t)->line = __LINE__; TASK_FALLTHROUGH; case __LINE__: \
+										if(! (cond)) return TASK_WAITING; } while(0)
+
+/* Timer waits - signed difference survives the HAL_GetTick wrap, waits up to 24 days */
+
+#define TASK_ELAPSED(t)				((int32_t)(TASK_NOW() - (t)->wake) >= 0)
+
+// Sleep at least ms from now
+#define TASK_SLEEP(t, ms)			do { (t)->wake = TASK_NOW() + (ms) + 1; TASK_WAIT_UNTIL(t, TASK_ELAPSED(t)); } while(0)
+
+// Wait for a polled condition, give up after at least ms - the caller checks the condition again
+#define TASK_WAIT_TIMEOUT(t, cond, ms)	do { (t)->wake = TASK_NOW() + (ms) + 1; \
+										TASK_WAIT_UNTIL(t, (cond) || TASK_ELAPSED(t)); } while(0)
+
+// Sleep until ms after the previous period started - fixed period regardless of the work and sleeps
+// in between, an overrun restarts the period from now instead of running the missed ones back to back
+#define TASK_SLEEP_PERIOD(t, ms)	do { (t)->release += (ms); \
+										if((int32_t)(TASK_NOW() - (t)->release) >= 0) (t)->release = TASK_NOW(); \
+										(t)->wake = (t)->release; \
+										TASK_WAIT_UNTIL(t, TASK_ELAPSED(t)); } while(0)
+
+/* Event waits */
+
+#define TASK_WAIT_EVENT(t, ev)		do { TASK_WAIT_UNTIL(t, (ev)); (ev) = 0; } while(0)
+
+// Wait for an event, give up after at least ms - the caller checks what the event announces
+#define TASK_WAIT_EVENT_TIMEOUT(t, ev, ms)	do { (t)->wake = TASK_NOW() + (ms) + 1; \
+										TASK_WAIT_UNTIL(t, (ev) || TASK_ELAPSED(t)); (ev) = 0; } while(0)
+
+// Drop an event signalled while nobody waited (contact bounce)
+#define TASK_CLEAR(ev)				((ev) = 0)
+
+#else
+
+#define TASK_BEGIN(t)				{ (void)(t)
+#define TASK_END(t)					} return TASK_DONE
+
+#define TASK_YIELD(t)				taskYIELD()
+
+#define TASK_WAIT_UNTIL(t, cond)	do { while(! (cond)) vTaskDelay(1); } while(0)
+
+#define TASK_SLEEP(t, ms)			vTaskDelay(pdMS_TO_TICKS(ms) + 1)
+
+#define TASK_WAIT_TIMEOUT(t, cond, ms)	do { TickType_t wake_ = xTaskGetTickCount() + pdMS_TO_TICKS(ms) + 1; \
+										while(! (cond) && (int32_t)(xTaskGetTickCount() - wake_) < 0) vTaskDelay(1); \
+									} while(0)
+
+// Same overrun rule as bare-metal - vTaskDelayUntil alone would run the missed periods back to back
+#define TASK_SLEEP_PERIOD(t, ms)	do { if((TickType_t)(xTaskGetTickCount() - (t)->release) >= pdMS_TO_TICKS(ms)) \
+											(t)->release = xTaskGetTickCount(); \
+										else vTaskDelayUntil(&(t)->release, pdMS_TO_TICKS(ms)); } while(0)
+
+#define TASK_WAIT_EVENT(t, ev)		xSemaphoreTake((ev).handle, portMAX_DELAY)
+#define TASK_WAIT_EVENT_TIMEOUT(t, ev, ms)	xSemaphoreTake((ev).handle, pdMS_TO_TICKS(ms) + 1)
+#define TASK_CLEAR(ev)				xSemaphoreTake((ev).handle, 0)
+
+#endif
+
+/* Functions */
+
+void TASK_eventInit(TASK_Event *event);
+void TASK_signal(TASK_Event *event);
+void TASK_start(TASK_Task *tasks, uint8_t count);
+uint8_t TASK_schedule(TASK_Task *tasks, uint8_t count);
+
+#ifdef USE_FREERTOS
+const TASK_Task *TASK_get(uint8_t index);
+uint32_t TASK_stackUsed(const TASK_Task *task);
+#endif
+
+#endif
@@ -66,6 +66,10 @@ void Error_Handler(void);
 #define USART_RX_GPIO_Port GPIOA
 #define LD2_Pin GPIO_PIN_5
 #define LD2_GPIO_Port GPIOA
+#define MOTOR_FWD_Pin GPIO_PIN_5
+#define MOTOR_FWD_GPIO_Port GPIOC
+#define MOTOR_BWD_Pin GPIO_PIN_6
+#define MOTOR_BWD_GPIO_Port GPIOC
 #define NRF24_CSN_Pin GPIO_PIN_8
 #define NRF24_CSN_GPIO_Port GPIOC
 #define NRF24_CE_Pin GPIO_PIN_9
@@ -77,7 +81,10 @@ void Error_Handler(void);
 #define SWO_Pin GPIO_PIN_3
 #define SWO_GPIO_Port GPIOB
 /* USER CODE BEGIN Private defines */
-
+// nRF24 IRQ (active low on TX_DS, MAX_RT and RX_DR) - wire module pin 8 to PC7 (Morpho CN10 19)
+#define NRF24_IRQ_Pin GPIO_PIN_7
+#define NRF24_IRQ_GPIO_Port GPIOC
+#define NRF24_IRQ_EXTI_IRQn EXTI9_5_IRQn
 /* USER CODE END Private defines */
 
 #ifdef __cplusplus
@@ -0,0 +1,103 @@
+/*
+Library for:				On-target microbenchmarks - boat suite
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- KK_BENCH harness
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_BENCH.h"
+
+#ifdef BENCHMARK
+
+#include "spi.h"
+#include "NRF24.h"
+#include "KK_MOTOR.h"
+#include "KK_TELEMETRY.h"
+
+/* Private defines */
+
+#define BENCH_ITERATIONS			1000
+#define BENCH_ITERATIONS_TELEMETRY	64			// frames that fit into logger buffer without draining
+
+/* Private variables */
+
+static const uint64_t bench_pipe_addr = 0x11223344AA;
+static uint8_t bench_rf_ch;
+static uint8_t bench_payload[MAX_PAYLOAD_SIZE];
+static volatile uint32_t bench_sink;
+
+/* Static function prototypes */
+
+static void BENCH_nrf24ReadRegister(uint32_t iteration);
+static void BENCH_nrf24WriteRegister(uint32_t iteration);
+static void BENCH_nrf24Available(uint32_t iteration);
+static void BENCH_nrf24Read(uint32_t iteration);
+static void BENCH_motorApply(uint32_t iteration);
+static void BENCH_telemetryControl(uint32_t iteration);
+
+/* Benchmarks */
+
+static void BENCH_nrf24ReadRegister(uint32_t iteration)
+{
+	bench_sink = NRF24_readRegister(REG_CONFIG);
+}
+
+// Writes back current channel - same SPI traffic, radio setup unchanged
+static void BENCH_nrf24WriteRegister(uint32_t iteration)
+{
+	NRF24_writeRegister(REG_RF_CH, bench_rf_ch);
+}
+
+static void BENCH_nrf24Available(uint32_t iteration)
+{
+	bench_sink = NRF24_available();
+}
+
+// Payload read and FIFO status as on every received packet (FIFO may be empty, SPI traffic is the same)
+static void BENCH_nrf24Read(uint32_t iteration)
+{
+	bench_sink = NRF24_read(bench_payload, PAYLOAD_SIZE);
+}
+
+// Speed and direction sweep through every branch of the mixing table
+static void BENCH_motorApply(uint32_t iteration)
+{
+	MOTOR_apply((uint8_t)((iteration * 7) % 101), (uint8_t)((iteration * 13) % 101));
+}
+
+// Framing and copy into logger buffer only, UART DMA runs in background
+static void BENCH_telemetryControl(uint32_t iteration)
+{
+	TELEMETRY_sendControl((uint8_t)iteration, 50, TELEMETRY_CONTROL_ACKED);
+}
+
+/* Functions */
+
+// PWM is never started here - mixing only writes compare registers and bridge pins, motors stay still
+void BENCH_suite(void)
+{
+	BENCH_init("RX");
+
+	TELEMETRY_init(TELEMETRY_SOURCE_RX);
+	NRF24_init(&hspi2);
+	NRF24_openReadingPipe(1, bench_pipe_addr);
+	NRF24_startListening();
+	bench_rf_ch = NRF24_readRegister(REG_RF_CH);
+
+	BENCH_run("nrf24_read_register", BENCH_nrf24ReadRegister, BENCH_ITERATIONS);
+	BENCH_run("nrf24_write_register", BENCH_nrf24WriteRegister, BENCH_ITERATIONS);
+	BENCH_run("nrf24_available", BENCH_nrf24Available, BENCH_ITERATIONS);
+	BENCH_run("nrf24_read", BENCH_nrf24Read, BENCH_ITERATIONS);
+	BENCH_run("motor_apply", BENCH_motorApply, BENCH_ITERATIONS);
+	MOTOR_apply(50, 50);
+	BENCH_run("telemetry_control", BENCH_telemetryControl, BENCH_ITERATIONS_TELEMETRY);
+
+	BENCH_end();
+
+	while(1);
+}
+
+#endif
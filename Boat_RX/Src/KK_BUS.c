@@ -0,0 +1,76 @@
+/*
+Library for:				Message bus - static publish / subscribe without copies or locks
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Linux kernel seqcount / single-producer ring buffer pattern
+							- GCC __atomic builtins (release / acquire ordering)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_BUS.h"
+
+/* Private macros */
+
+#define BUS_MASK					(BUS_SLOTS - 1)
+#define BUS_SLOT(topic, seq)		((uint8_t *)(topic)->slots + ((seq) & BUS_MASK) * (topic)->size)
+
+_Static_assert((BUS_SLOTS & BUS_MASK) == 0 && BUS_SLOTS >= 2, "BUS_SLOTS must be a power of 2");
+
+/* Functions */
+
+// Slot of the next message - nobody reads it until BUS_publish
+void *BUS_claim(BUS_Topic *topic)
+{
+	return BUS_SLOT(topic, topic->seq + 1);
+}
+
+// Single store makes the claimed slot the newest message, release orders the payload before it
+uint32_t BUS_publish(BUS_Topic *topic)
+{
+	uint32_t seq = topic->seq + 1;
+
+	__atomic_store_n(&topic->seq, seq, __ATOMIC_RELEASE);
+
+	return seq;
+}
+
+// Newest message when it is newer than the last one this reader got, NULL otherwise
+const void *BUS_read(BUS_Reader *reader)
+{
+	uint32_t seq = __atomic_load_n(&reader->topic->seq, __ATOMIC_ACQUIRE);
+
+	if(seq == reader->seq)
+		return NULL;
+
+	reader->missed += seq - reader->seq - 1;
+	reader->seq = seq;
+
+	return BUS_SLOT(reader->topic, seq);
+}
+
+// Message newer than the last BUS_read - does not consume it
+uint8_t BUS_pending(const BUS_Reader *reader)
+{
+	return __atomic_load_n(&reader->topic->seq, __ATOMIC_ACQUIRE) != reader->seq ? BUS_TRUE : BUS_FALSE;
+}
+
+// Newest message without a reader (state topics), NULL before the first publish
+const void *BUS_latest(const BUS_Topic *topic)
+{
+	uint32_t seq = __atomic_load_n(&topic->seq, __ATOMIC_ACQUIRE);
+
+	if(seq == 0)
+		return NULL;
+
+	return BUS_SLOT(topic, seq);
+}
+
+// Message from the last BUS_read is not being overwritten yet - the producer claims seq + 1 next
+uint8_t BUS_valid(const BUS_Reader *reader)
+{
+	uint32_t seq = __atomic_load_n(&reader->topic->seq, __ATOMIC_ACQUIRE);
+
+	return (seq - reader->seq) < (BUS_SLOTS - 1) ? BUS_TRUE : BUS_FALSE;
+}
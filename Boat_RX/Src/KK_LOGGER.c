@@ -0,0 +1,184 @@
+/*
+Library for:				UART logger - DMA driven ring buffer
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32F4 HAL UART DMA driver
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_LOGGER.h"
+
+#ifdef USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+/* Private handles and variables */
+
+static UART_HandleTypeDef *logger_huart;
+
+// Ring buffer - head moved only by writers (main loop / tasks), tail only by DMA completion
+static uint8_t logger_buffer[LOGGER_BUFFER_SIZE];
+static volatile uint16_t logger_head = 0;
+static volatile uint16_t logger_tail = 0;
+static volatile uint16_t logger_chunk = 0;
+static volatile uint32_t logger_dropped = 0;
+
+// Last byte received from host, consumed by LOGGER_getCommand
+static uint8_t logger_rx = 0;
+static volatile uint8_t logger_command = LOGGER_CMD_NONE;
+
+/* Private macros */
+
+#define LOGGER_MASK					(LOGGER_BUFFER_SIZE - 1)
+
+/* Static function prototypes */
+
+static void LOGGER_kick(void);
+
+/* Functions */
+
+// Logger Initialization function - switches USART to logger baud rate
+void LOGGER_init(UART_HandleTypeDef *huart)
+{
+	logger_huart = huart;
+	logger_head = 0;
+	logger_tail = 0;
+	logger_chunk = 0;
+	logger_dropped = 0;
+	logger_command = LOGGER_CMD_NONE;
+
+	if(logger_huart->Init.BaudRate != LOGGER_BAUDRATE)
+	{
+		logger_huart->Init.BaudRate = LOGGER_BAUDRATE;
+		HAL_UART_Init(logger_huart);
+	}
+
+	HAL_UART_Receive_IT(logger_huart, &logger_rx, 1);
+}
+
+// Start DMA on the longest contiguous part of buffer (caller masks interrupts)
+static void LOGGER_kick(void)
+{
+	uint16_t head = logger_head;
+	uint16_t tail = logger_tail;
+
+	if(logger_chunk || head == tail || logger_huart == NULL)
+		return;
+
+	// Wrapped data goes out in second transfer
+	logger_chunk = (head > tail) ? (head - tail) : (LOGGER_BUFFER_SIZE - tail);
+
+	if(HAL_UART_Transmit_DMA(logger_huart, &logger_buffer[tail], logger_chunk) != HAL_OK)
+		logger_chunk = 0;
+}
+
+// Append record - whole record is copied or dropped and counted, never waits for UART
+// USE_FREERTOS: tasks preempt each other, writers are serialised with the scheduler suspended -
+// interrupts stay enabled during the copy, only the kick masks them like on bare-metal
+uint8_t LOGGER_write(const void *data, uint16_t len)
+{
+#ifdef USE_FREERTOS
+	uint8_t scheduler = xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+	if(scheduler)
+		vTaskSuspendAll();
+#endif
+
+	uint16_t head = logger_head;
+	uint16_t space = (LOGGER_BUFFER_SIZE - 1) - ((head - logger_tail) & LOGGER_MASK);
+
+	if(len > space)
+	{
+		logger_dropped++;
+#ifdef USE_FREERTOS
+		if(scheduler)
+			xTaskResumeAll();
+#endif
+		return LOGGER_FALSE;
+	}
+
+	// Copy in at most two pieces around buffer end
+	uint16_t first = LOGGER_BUFFER_SIZE - head;
+	if(first > len)
+		first = len;
+	memcpy(&logger_buffer[head], data, first);
+	memcpy(logger_buffer, (const uint8_t *)data + first, len - first);
+
+	// Publish record after it has been copied
+	logger_head = (head + len) & LOGGER_MASK;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	LOGGER_kick();
+	__set_PRIMASK(primask);
+
+#ifdef USE_FREERTOS
+	if(scheduler)
+		xTaskResumeAll();
+#endif
+	return LOGGER_TRUE;
+}
+
+// Number of records dropped because buffer was full
+uint32_t LOGGER_getDropped(void)
+{
+	return logger_dropped;
+}
+
+// Nothing buffered and no transfer in flight
+uint8_t LOGGER_isIdle(void)
+{
+	return (logger_head == logger_tail) && !logger_chunk;
+}
+
+// Pending host command or LOGGER_CMD_NONE - newer command overwrites unread one
+uint8_t LOGGER_getCommand(void)
+{
+	uint8_t command = logger_command;
+
+	logger_command = LOGGER_CMD_NONE;
+	return command;
+}
+
+// Call from HAL_UART_TxCpltCallback
+void LOGGER_txCplt(UART_HandleTypeDef *huart)
+{
+	if(huart != logger_huart)
+		return;
+
+	logger_tail = (logger_tail + logger_chunk) & LOGGER_MASK;
+	logger_chunk = 0;
+
+	LOGGER_kick();
+}
+
+// Call from HAL_UART_RxCpltCallback
+void LOGGER_rxCplt(UART_HandleTypeDef *huart)
+{
+	if(huart != logger_huart)
+		return;
+
+	logger_command = logger_rx;
+	HAL_UART_Receive_IT(logger_huart, &logger_rx, 1);
+}
+
+// Call from HAL_UART_ErrorCallback - overrun stops reception, DMA error aborts transfer
+void LOGGER_error(UART_HandleTypeDef *huart)
+{
+	if(huart != logger_huart)
+		return;
+
+	// Transfer in flight is lost, skip it and continue with the rest
+	if(logger_chunk && huart->gState == HAL_UART_STATE_READY)
+	{
+		logger_tail = (logger_tail + logger_chunk) & LOGGER_MASK;
+		logger_chunk = 0;
+		logger_dropped++;
+		LOGGER_kick();
+	}
+
+	if(huart->RxState == HAL_UART_STATE_READY)
+		HAL_UART_Receive_IT(logger_huart, &logger_rx, 1);
+}
@@ -0,0 +1,97 @@
+/*
+Library for:				Boat motor mixing (speed / direction to H-bridge and PWM)
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32F446RE Reference Manual (TIM1 PWM)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Headers */
+#include "KK_MOTOR.h"
+#include "main.h"
+#include "KK_PIN.h"
+
+/* Binding checks */
+
+PIN_ASSERT(MOTOR_FWD_GPIO_Port, MOTOR_FWD_Pin);
+PIN_ASSERT(MOTOR_BWD_GPIO_Port, MOTOR_BWD_Pin);
+PIN_ASSERT_DISTINCT(MOTOR_FWD_GPIO_Port, MOTOR_FWD_Pin, MOTOR_BWD_GPIO_Port, MOTOR_BWD_Pin);
+_Static_assert(IS_TIM_CC2_INSTANCE(MOTOR_PWM_TIM), "MOTOR_PWM_TIM needs two PWM channels");
+
+/* Private macros */
+
+// Same as HAL_GPIO_WritePin, without a call back into flash
+#define MOTOR_FORWARD()				do { PIN_SET(MOTOR_FWD_GPIO_Port, MOTOR_FWD_Pin); PIN_RESET(MOTOR_BWD_GPIO_Port, MOTOR_BWD_Pin); } while(0)
+#define MOTOR_BACKWARD()			do { PIN_RESET(MOTOR_FWD_GPIO_Port, MOTOR_FWD_Pin); PIN_SET(MOTOR_BWD_GPIO_Port, MOTOR_BWD_Pin); } while(0)
+#define MOTOR_STOP()				do { PIN_RESET(MOTOR_FWD_GPIO_Port, MOTOR_FWD_Pin); PIN_RESET(MOTOR_BWD_GPIO_Port, MOTOR_BWD_Pin); } while(0)
+
+/* Functions */
+
+// Speed and direction in percent, 50 is centre - sets bridge direction pins and PWM duty of both motors
+// Runs from SRAM (KK_RAMFUNC.h) - integer halving keeps soft-float double helpers out of this path
+RAMFUNC void MOTOR_apply(uint8_t speed, uint8_t direction){
+	if((speed >= 40) && (speed <= 60)){
+		// IDLE STATE - STOP
+		MOTOR_STOP();
+		MOTOR_PWM_TIM->MOTOR_PWM_LEFT = 0;
+		MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = 0;
+	}
+	else if((speed >= 0) && (speed < 40)){
+		// SAIL BACKWARD
+		MOTOR_BACKWARD();
+		if((direction >= 40) && (direction <= 60)){
+			// SAIL STRAIGHT
+			MOTOR_PWM_TIM->MOTOR_PWM_LEFT = speed;
+			MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = speed;
+		}
+		else if((direction >= 0) && (direction < 20)){
+			// SAIL FULL LEFT
+			MOTOR_PWM_TIM->MOTOR_PWM_LEFT = speed;
+			MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = 0;
+		}
+		else if((direction >= 20) && (direction < 40)){
+			// SAIL HALF LEFT
+			MOTOR_PWM_TIM->MOTOR_PWM_LEFT = speed;
+			MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = speed / 2;
+		}
+		else if((direction > 80) && (direction <= 100)){
+			// SAIL FULL RIGHT
+			MOTOR_PWM_TIM->MOTOR_PWM_LEFT = 0;
+			MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = speed;
+		}
+		else if((direction > 60) && (direction <= 80)){
+			// SAIL HALF RIGHT
+			MOTOR_PWM_TIM->MOTOR_PWM_LEFT = speed / 2;
+			MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = speed;
+		}
+	}
+	else if((speed > 60) && (speed <= 100)){
+		// SAIL FORWARD
+		MOTOR_FORWARD();
+		if((direction >= 40) && (direction <= 60)){
+			// SAIL STRAIGHT
+			MOTOR_PWM_TIM->MOTOR_PWM_LEFT = speed;
+			MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = speed;
+		}
+		else if((direction >= 0) && (direction < 20)){
+			// SAIL FULL LEFT
+			MOTOR_PWM_TIM->MOTOR_PWM_LEFT = 0;
+			MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = speed;
+		}
+		else if((direction >= 20) && (direction < 40)){
+			// SAIL HALF LEFT
+			MOTOR_PWM_TIM->MOTOR_PWM_LEFT = speed / 2;
+			MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = speed;
+		}
+		else if((direction > 80) && (direction <= 100)){
+			// SAIL FULL RIGHT
+			MOTOR_PWM_TIM->MOTOR_PWM_LEFT = speed;
+			MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = 0;
+		}
+		else if((direction > 60) && (direction <= 80)){
+			// SAIL HALF RIGHT
+			MOTOR_PWM_TIM->MOTOR_PWM_LEFT = speed;
+			MOTOR_PWM_TIM->MOTOR_PWM_RIGHT = speed / 2;
+		}
+	}
+}
@@ -0,0 +1,93 @@
+/*
+Library for:				Cycle profiler - DWT cycle counter zones
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- ARMv7-M Architecture Reference Manual, C1.8 Data Watchpoint and Trace unit
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_PROFILER.h"
+
+#if PROFILER_ENABLED
+
+#include "KK_TELEMETRY.h"
+
+/* Public variables */
+
+PROFILER_Zone PROFILER_zones[PROFILER_ZONE_COUNT];
+
+/* Private variables */
+
+// Cycles of an empty zone, subtracted from reported min/max/mean
+static uint32_t profiler_overhead = 0;
+
+/* Static function prototypes */
+
+static void PROFILER_put32(uint8_t *dst, uint32_t value);
+
+/* Functions */
+
+// Profiler Initialization function - starts cycle counter and measures zone overhead
+void PROFILER_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	PROFILER_reset();
+	{
+		PROFILER_SCOPE(PROFILER_ZONE_LOOP);
+	}
+	profiler_overhead = PROFILER_zones[PROFILER_ZONE_LOOP].min;
+	PROFILER_reset();
+}
+
+void PROFILER_reset(void)
+{
+	memset(PROFILER_zones, 0, sizeof(PROFILER_zones));
+	for(uint8_t i = 0; i < PROFILER_ZONE_COUNT; i++)
+		PROFILER_zones[i].min = UINT32_MAX;
+}
+
+static void PROFILER_put32(uint8_t *dst, uint32_t value)
+{
+	dst[0] = (uint8_t)(value);
+	dst[1] = (uint8_t)(value >> 8);
+	dst[2] = (uint8_t)(value >> 16);
+	dst[3] = (uint8_t)(value >> 24);
+}
+
+// One PROFILE telemetry record per used zone
+void PROFILER_report(void)
+{
+	uint8_t payload[TELEMETRY_PROFILE_SIZE];
+
+	for(uint8_t i = 0; i < PROFILER_ZONE_COUNT; i++)
+	{
+		// Snapshot first, zones keep counting while report is built
+		PROFILER_Zone z = PROFILER_zones[i];
+		if(z.count == 0)
+			continue;
+
+		uint32_t mean = (uint32_t)(z.sum / z.count);
+
+		payload[0] = i;
+		payload[1] = (uint8_t)(SystemCoreClock / 1000000);
+		PROFILER_put32(&payload[2], z.count);
+		PROFILER_put32(&payload[6], z.min > profiler_overhead ? z.min - profiler_overhead : 0);
+		PROFILER_put32(&payload[10], z.max > profiler_overhead ? z.max - profiler_overhead : 0);
+		PROFILER_put32(&payload[14], mean > profiler_overhead ? mean - profiler_overhead : 0);
+		for(uint8_t b = 0; b < PROFILER_BUCKETS; b++)
+		{
+			uint16_t count = z.histogram[b] > UINT16_MAX ? UINT16_MAX : (uint16_t)z.histogram[b];
+			payload[18 + 2 * b] = (uint8_t)count;
+			payload[19 + 2 * b] = (uint8_t)(count >> 8);
+		}
+
+		TELEMETRY_send(TELEMETRY_TYPE_PROFILE, payload, sizeof(payload));
+	}
+}
+
+#endif
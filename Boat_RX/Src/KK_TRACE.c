@@ -0,0 +1,72 @@
+/*
+Library for:				Event trace over ITM stimulus ports (SWO pin PB3)
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- ARMv7-M Architecture Reference Manual, Appendix D4 Debug ITM and DWT Packet Protocol
+							- RM0390 STM32F446xx Reference Manual, 33.14 TPIU
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_TRACE.h"
+
+#if TRACE_ENABLED
+
+/* Functions */
+
+// Trace Initialization function - sets up SWO itself, so any SWV receiver at TRACE_SWO_BAUD works
+void TRACE_init(uint8_t source)
+{
+	// Without debugger attached there is nobody to listen, keep ITM off
+	if(!(CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk))
+		return;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	// Asynchronous trace on PB3 (TRACE_MODE = 00)
+	DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+
+	// TPIU - NRZ (UART like) protocol, no formatter
+	TPI->SPPR = 2;
+	TPI->ACPR = SystemCoreClock / TRACE_SWO_BAUD - 1;
+	TPI->FFCR = 0x100;
+
+	// ITM - unlock, ATB ID 1, stimulus ports only, no hardware timestamps (CYCCNT is sent instead)
+	ITM->LAR = 0xC5ACCE55;
+	ITM->TCR = (1UL << ITM_TCR_TraceBusID_Pos) | ITM_TCR_SWOENA_Msk | ITM_TCR_ITMENA_Msk;
+	ITM->TPR = 0;
+	ITM->TER = (1UL << TRACE_PORT_TEXT) | (1UL << TRACE_PORT_TIME) | (1UL << TRACE_PORT_EVENT);
+
+	TRACE_event(TRACE_EVENT_SYNC, source);
+}
+
+// SWO prescaler for current HCLK, called again by KK_CLOCK after every profile switch
+void TRACE_retime(void)
+{
+	if(!(ITM->TCR & ITM_TCR_ITMENA_Msk))
+		return;
+
+	TPI->ACPR = SystemCoreClock / TRACE_SWO_BAUD - 1;
+}
+
+// Text on port 0 - waits for FIFO like ITM_SendChar, returns 0 when ITM is off
+uint8_t TRACE_write(const char *text, int len)
+{
+	if(!(ITM->TCR & ITM_TCR_ITMENA_Msk) || !(ITM->TER & (1UL << TRACE_PORT_TEXT)))
+		return 0;
+
+	for(int i = 0; i < len; i++)
+	{
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		while(ITM->PORT[TRACE_PORT_TEXT].u32 == 0)
+			;
+		ITM->PORT[TRACE_PORT_TEXT].u8 = (uint8_t)text[i];
+		__set_PRIMASK(primask);
+	}
+	return 1;
+}
+
+#endif
@@ -11,10 +11,14 @@ Last update:				08/01/2021
 /* Includes */
 
 #include "NRF24.h"
+#include "main.h"
+#include "KK_PIN.h"
+#include "KK_TRACE.h"
 
 /* Private handles and variables */
 
 static SPI_HandleTypeDef *nrf24_hspi;
+static SPI_TypeDef *nrf24_spi;
 
 uint8_t payload_size = PAYLOAD_SIZE;
 
@@ -23,10 +27,19 @@ uint8_t payload_size = PAYLOAD_SIZE;
 // Data shift
 #define _DS(x, n) (x << n)
 
+/* Pin binding - CubeMX labels in main.h */
+
+PIN_ASSERT(NRF24_CSN_GPIO_Port, NRF24_CSN_Pin);
+PIN_ASSERT(NRF24_CE_GPIO_Port, NRF24_CE_Pin);
+PIN_ASSERT_DISTINCT(NRF24_CSN_GPIO_Port, NRF24_CSN_Pin, NRF24_CE_GPIO_Port, NRF24_CE_Pin);
+
 /* Static function prototypes */
 
 static void NRF24_CSN(uint8_t state);
 static void NRF24_CE(uint8_t state);
+static void NRF24_spiSpeed(void);
+static void NRF24_spiTransmit(const uint8_t *buf, uint8_t len);
+static void NRF24_spiReceive(uint8_t *buf, uint8_t len);
 static void NRF24_write_register(uint8_t reg, uint8_t value);
 static void NRF24_write_registerN(uint8_t reg, const uint8_t* buf, uint8_t len);
 static uint8_t NRF24_read_register(uint8_t reg);
@@ -42,6 +55,8 @@ void NRF24_init(SPI_HandleTypeDef *nrfSPI)
 {
 	// Copy SPI handle
 	nrf24_hspi = nrfSPI;
+	nrf24_spi = nrfSPI->Instance;
+	NRF24_spiSpeed();
 
 	// Put Pins To Idle State
 	NRF24_CSN(HIGH);
@@ -107,22 +122,101 @@ void NRF24_init(SPI_HandleTypeDef *nrfSPI)
 	NRF24_power(LOW);
 }
 
+#if NRF24_USE_LL
+
+// CSN Pin operations
+static inline void NRF24_CSN(uint8_t state)
+{
+	if (state){
+		PIN_SET(NRF24_CSN_GPIO_Port, NRF24_CSN_Pin);
+		TRACE_event(TRACE_EVENT_SPI_END, 0);
+	}
+	else{
+		TRACE_event(TRACE_EVENT_SPI_BEGIN, 0);
+		PIN_RESET(NRF24_CSN_GPIO_Port, NRF24_CSN_Pin);
+	}
+}
+
+// CE Pin operations
+static inline void NRF24_CE(uint8_t state)
+{
+	PIN_WRITE(NRF24_CE_GPIO_Port, NRF24_CE_Pin, state);
+}
+
+// One full-duplex byte, 8-bit DR access so only one frame is pushed
+static inline uint8_t NRF24_spiExchange(uint8_t byte)
+{
+	while(!(nrf24_spi->SR & SPI_SR_TXE));
+	*(volatile uint8_t *)&nrf24_spi->DR = byte;
+	while(!(nrf24_spi->SR & SPI_SR_RXNE));
+	return *(volatile uint8_t *)&nrf24_spi->DR;
+}
+
+static void NRF24_spiTransmit(const uint8_t *buf, uint8_t len)
+{
+	nrf24_spi->CR1 |= SPI_CR1_SPE;
+	while(len--)
+		(void)NRF24_spiExchange(*buf++);
+	while(nrf24_spi->SR & SPI_SR_BSY);
+}
+
+// NOP clocks data out, NRF24 ignores MOSI after the command byte
+static void NRF24_spiReceive(uint8_t *buf, uint8_t len)
+{
+	nrf24_spi->CR1 |= SPI_CR1_SPE;
+	while(len--)
+		*buf++ = NRF24_spiExchange(CMD_NOP);
+	while(nrf24_spi->SR & SPI_SR_BSY);
+}
+
+#else
+
 // CSN Pin operations
 static void NRF24_CSN(uint8_t state)
 {
-	if (state)
-		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_8, GPIO_PIN_SET);
-	else
-		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_8, GPIO_PIN_RESET);
+	if (state){
+		HAL_GPIO_WritePin(NRF24_CSN_GPIO_Port, NRF24_CSN_Pin, GPIO_PIN_SET);
+		TRACE_event(TRACE_EVENT_SPI_END, 0);
+	}
+	else{
+		TRACE_event(TRACE_EVENT_SPI_BEGIN, 0);
+		HAL_GPIO_WritePin(NRF24_CSN_GPIO_Port, NRF24_CSN_Pin, GPIO_PIN_RESET);
+	}
 }
 
 // CE Pin operations
 static void NRF24_CE(uint8_t state)
 {
 	if (state)
-		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_9, GPIO_PIN_SET);
+		HAL_GPIO_WritePin(NRF24_CE_GPIO_Port, NRF24_CE_Pin, GPIO_PIN_SET);
 	else
-		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_9, GPIO_PIN_RESET);
+		HAL_GPIO_WritePin(NRF24_CE_GPIO_Port, NRF24_CE_Pin, GPIO_PIN_RESET);
+}
+
+static void NRF24_spiTransmit(const uint8_t *buf, uint8_t len)
+{
+	HAL_SPI_Transmit(nrf24_hspi, (uint8_t *)buf, len, 100);
+}
+
+static void NRF24_spiReceive(uint8_t *buf, uint8_t len)
+{
+	HAL_SPI_Receive(nrf24_hspi, buf, len, 100);
+}
+
+#endif
+
+// Fastest SPI divider within NRF24_SPI_MAX_HZ, BR field n divides by 2^(n+1)
+static void NRF24_spiSpeed(void)
+{
+	uint32_t bus = ((uintptr_t)nrf24_spi >= APB2PERIPH_BASE) ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+	uint32_t br = 0;
+
+	while(br < 7 && (bus >> (br + 1)) > NRF24_SPI_MAX_HZ)
+		br++;
+
+	nrf24_spi->CR1 &= ~SPI_CR1_SPE;
+	MODIFY_REG(nrf24_spi->CR1, SPI_CR1_BR, br << SPI_CR1_BR_Pos);
+	nrf24_hspi->Init.BaudRatePrescaler = br << SPI_CR1_BR_Pos;
 }
 
 // Write 1B to specific register (W_REGISTER command - 46 page in the datasheet)
@@ -135,7 +229,7 @@ static void NRF24_write_register(uint8_t reg, uint8_t value)
 	//Transmit register address and data
 	SPI_Buf[0] = reg | CMD_W_REGISTER;
 	SPI_Buf[1] = value;
-	HAL_SPI_Transmit(nrf24_hspi, SPI_Buf, 2, 100);
+	NRF24_spiTransmit(SPI_Buf, 2);
 
 	NRF24_CSN(HIGH);
 }
@@ -149,8 +243,8 @@ static void NRF24_write_registerN(uint8_t reg, const uint8_t* buf, uint8_t len)
 
 	//Transmit register address and data
 	SPI_Buf[0] = reg | CMD_W_REGISTER;
-	HAL_SPI_Transmit(nrf24_hspi, SPI_Buf, 1, 100);
-	HAL_SPI_Transmit(nrf24_hspi, (uint8_t*)buf, len, 100);
+	NRF24_spiTransmit(SPI_Buf, 1);
+	NRF24_spiTransmit(buf, len);
 
 	NRF24_CSN(HIGH);
 }
@@ -164,10 +258,10 @@ static uint8_t NRF24_read_register(uint8_t reg)
 
 	//Transmit register address
 	SPI_Buf[0] = reg & 0x1F;
-	HAL_SPI_Transmit(nrf24_hspi, SPI_Buf, 1, 100);
+	NRF24_spiTransmit(SPI_Buf, 1);
 
 	//Receive data
-	HAL_SPI_Receive(nrf24_hspi, &SPI_Buf[1], 1, 100);
+	NRF24_spiReceive(&SPI_Buf[1], 1);
 
 	NRF24_CSN(HIGH);
 
@@ -250,6 +344,20 @@ void NRF24_openReadingPipe(uint8_t number, uint64_t address)
 
 // Write Data - function returns 1 if data has been sent successfully (described below)
 uint8_t NRF24_write(const void* buf, uint8_t len)
+{
+	uint32_t start = HAL_GetTick();
+
+	NRF24_writeStart(buf, len);
+
+	// A fixed 1 ms is shorter than the worst case power-up (Tpd2stby 1.5 ms) - poll STATUS instead
+	while(!NRF24_writeDone() && (HAL_GetTick() - start) <= NRF24_TX_TIMEOUT);
+
+	return NRF24_writeFinish();
+}
+
+// Write Data, first half - loads the payload and raises CE, the caller waits for the IRQ line or
+// NRF24_writeDone (at most NRF24_TX_TIMEOUT ms) before NRF24_writeFinish
+void NRF24_writeStart(const void* buf, uint8_t len)
 {
 	// Reset status register (in case - when i don't reset, it sometimes crashes)
 	NRF24_resetStatus();
@@ -264,16 +372,24 @@ uint8_t NRF24_write(const void* buf, uint8_t len)
 
 	// Send payload with proper command (46 page in the datasheet)
 	uint8_t wrPayloadCmd = CMD_W_TX_PAYLOAD;
-	HAL_SPI_Transmit(nrf24_hspi, &wrPayloadCmd, 1, 100);
-	HAL_SPI_Transmit(nrf24_hspi, (uint8_t *)buf, len, 100);
+	NRF24_spiTransmit(&wrPayloadCmd, 1);
+	NRF24_spiTransmit(buf, len);
 
 	NRF24_CSN(HIGH);
 
-	// Enable Tx for 1ms (HIGH pulse on CE starts transmission - 65 page in the datasheet)
+	// Enable Tx until NRF24_writeFinish (HIGH pulse on CE starts transmission - 65 page in the datasheet)
 	NRF24_CE(HIGH);
+}
 
-	HAL_Delay(1);
+// Write Data, packet finished - function returns non-zero once TX_DS or MAX_RT is set
+uint8_t NRF24_writeDone(void)
+{
+	return (uint8_t)(NRF24_read_register(REG_STATUS) & (_DS(1, STATUS_TX_DS) | _DS(1, STATUS_MAX_RT)));
+}
 
+// Write Data, second half - function returns 1 if data has been sent successfully
+uint8_t NRF24_writeFinish(void)
+{
 	NRF24_CE(LOW);
 
 	//Power down
@@ -292,8 +408,8 @@ uint8_t NRF24_read(void* buf, uint8_t len)
 
 	// Read payload with proper command (46 page in the datasheet)
 	cmdRxBuf = CMD_R_RX_PAYLOAD;
-	HAL_SPI_Transmit(nrf24_hspi, &cmdRxBuf, 1, 100);
-	HAL_SPI_Receive(nrf24_hspi, buf, len, 100);
+	NRF24_spiTransmit(&cmdRxBuf, 1);
+	NRF24_spiReceive(buf, len);
 
 	NRF24_CSN(HIGH);
 
@@ -330,3 +446,14 @@ uint8_t NRF24_available(void)
 	}
 	return result;
 }
+
+// Single register access for diagnostics and benchmarks
+uint8_t NRF24_readRegister(uint8_t reg)
+{
+	return NRF24_read_register(reg);
+}
+
+void NRF24_writeRegister(uint8_t reg, uint8_t value)
+{
+	NRF24_write_register(reg, value);
+}
@@ -28,16 +28,52 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "NRF24.h"
+#include "KK_LOGGER.h"
+#include "KK_TELEMETRY.h"
+#include "KK_PROFILER.h"
+#include "KK_TRACE.h"
+#include "KK_MOTOR.h"
+#include "KK_BENCH.h"
+#include "KK_MEMSTAT.h"
+#include "KK_CLOCK.h"
+#include "KK_TASK.h"
+#include "KK_BUS.h"
+#include "KK_RAMFUNC.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN PTD */
+// Bus messages - filled in place in BUS_TOPIC slots, consumers get pointers into them
+typedef struct
+{
+	uint8_t speed;					// 0 - 100 %
+	uint8_t direction;
+	uint8_t sequence;				// lets host tools pair TX and RX traces
+} ControlMsg;						// radio payload as is
+
+typedef struct
+{
+	uint32_t packets;
+	uint32_t last;					// HAL_GetTick() of the packet
+	uint32_t loop_us;				// packet handling time in the radio task
+	uint32_t loop_us_max;
+} LinkMsg;
+
+typedef struct
+{
+	uint8_t active;					// 1 - link lost, motors idle
+	uint32_t outage;				// entry - ms since last packet, exit - ms without link
+} FailsafeMsg;
 
+_Static_assert(sizeof(ControlMsg) == PAYLOAD_SIZE, "ControlMsg is the radio payload");
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
 #define IDLE_STATE 50
+#define TELEMETRY_PERIOD 1000
+#define LINK_TIMEOUT 1400
+#define RADIO_POLL_PERIOD 10
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -49,18 +85,247 @@
 
 /* USER CODE BEGIN PV */
 static const uint64_t rx_pipe_addr = 0x11223344AA;
-static uint8_t my_rx_data[MAX_PAYLOAD_SIZE + 2];
+
+// Producers: radio - control, link; failsafe - failsafe
+BUS_TOPIC(bus_control, ControlMsg);
+BUS_TOPIC(bus_link, LinkMsg);
+BUS_TOPIC(bus_failsafe, FailsafeMsg);
+
+// Mixer is on the latency path, radio and failsafe wake it and the logger after publishing
+static TASK_Event mixer_wake;
+static TASK_Event logger_wake;
+static TASK_Event radio_irq;
+static TASK_Event command_ready;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 /* USER CODE BEGIN PFP */
-
+static uint8_t radioAvailable(void);
+static uint32_t linkAge(uint32_t start);
+static void radioReceive(void);
+static void failsafeEnter(uint32_t outage);
+static uint8_t radioTask(TASK_Task *t);
+static uint8_t mixerTask(TASK_Task *t);
+static uint8_t failsafeTask(TASK_Task *t);
+static uint8_t loggerTask(TASK_Task *t);
+static uint8_t commandTask(TASK_Task *t);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+// Tasks resume where they waited - state that has to survive a wait is static
+
+static uint8_t radioAvailable(void)
+{
+	PROFILER_BEGIN(PROFILER_ZONE_NRF24_AVAILABLE);
+	uint8_t available = NRF24_available();
+	PROFILER_END(PROFILER_ZONE_NRF24_AVAILABLE);
+
+	return available;
+}
+
+// Time since the last packet, since start before the first one
+static uint32_t linkAge(uint32_t start)
+{
+	const LinkMsg *link = BUS_latest(&bus_link);
+
+	return HAL_GetTick() - (link != NULL ? link->last : start);
+}
+
+// Control frame from FIFO to the mixer - runs from SRAM (KK_RAMFUNC.h) like MOTOR_apply, so the path
+// from RX_DR to the compare registers does not wait on flash. SPI and HAL calls stay in flash
+RAMFUNC static void radioReceive(void)
+{
+	static uint32_t packets;
+	static uint32_t loop_us_max;
+
+	uint32_t loop_start_us = TELEMETRY_timestamp();
+	PROFILER_BEGIN(PROFILER_ZONE_LOOP);
+	TRACE_event(TRACE_EVENT_TASK_START, PROFILER_ZONE_LOOP);
+
+	ControlMsg *frame = BUS_claim(&bus_control);
+	PROFILER_BEGIN(PROFILER_ZONE_NRF24_READ);
+	NRF24_read(frame, PAYLOAD_SIZE);
+	PROFILER_END(PROFILER_ZONE_NRF24_READ);
+	TRACE_event(TRACE_EVENT_RADIO_RX, TRACE_RADIO_ARG((const uint8_t *)frame));
+	BUS_publish(&bus_control);
+	TASK_signal(&mixer_wake);
+	TASK_signal(&logger_wake);
+	packets++;
+
+	// Packet handling time - read and publish, mixing and logging run in their own tasks
+	uint32_t loop_us = TELEMETRY_timestamp() - loop_start_us;
+	if(loop_us > loop_us_max)
+		loop_us_max = loop_us;
+
+	LinkMsg *link = BUS_claim(&bus_link);
+	link->packets = packets;
+	link->last = HAL_GetTick();
+	link->loop_us = loop_us;
+	link->loop_us_max = loop_us_max;
+	BUS_publish(&bus_link);
+
+	PROFILER_END(PROFILER_ZONE_LOOP);
+	TRACE_event(TRACE_EVENT_TASK_STOP, PROFILER_ZONE_LOOP);
+}
+
+// Failsafe state to the mixer, which idles the motors - SRAM like the packet path it replaces
+RAMFUNC static void failsafeEnter(uint32_t outage)
+{
+	FailsafeMsg *state = BUS_claim(&bus_failsafe);
+	state->active = 1;
+	state->outage = outage;
+	TRACE_event(TRACE_EVENT_FAILSAFE_ENTER, outage);
+	BUS_publish(&bus_failsafe);
+	TASK_signal(&mixer_wake);
+	TASK_signal(&logger_wake);
+}
+
+// Packet straight into a bus slot - RX_DR on the IRQ line wakes the task, status register is read
+// once per wake-up. The RADIO_POLL_PERIOD timeout covers a lost edge and boards without the IRQ wire
+static uint8_t radioTask(TASK_Task *t)
+{
+	TASK_BEGIN(t);
+
+	for(;;){
+		TASK_WAIT_EVENT_TIMEOUT(t, radio_irq, RADIO_POLL_PERIOD);
+		if(! radioAvailable())
+			continue;
+
+		radioReceive();
+	}
+
+	TASK_END(t);
+}
+
+// Motors follow the newest frame, failsafe entry idles them until the next frame arrives
+static uint8_t mixerTask(TASK_Task *t)
+{
+	static BUS_Reader frames = BUS_READER(bus_control);
+	static BUS_Reader states = BUS_READER(bus_failsafe);
+
+	TASK_BEGIN(t);
+
+	for(;;){
+		TASK_WAIT_EVENT(t, mixer_wake);
+
+		const FailsafeMsg *state = BUS_read(&states);
+		const ControlMsg *frame = BUS_read(&frames);
 
+		PROFILER_BEGIN(PROFILER_ZONE_MIXING);
+		if(frame != NULL)
+			MOTOR_apply(frame->speed, frame->direction);
+		else if(state != NULL && state->active)
+			MOTOR_apply(IDLE_STATE, IDLE_STATE);
+		PROFILER_END(PROFILER_ZONE_MIXING);
+	}
+
+	TASK_END(t);
+}
+
+// No packet for LINK_TIMEOUT - failsafe state for the mixer and logger, HSI clock.
+// Clock profile changes only with the link state and never on the radio path - a switch waits
+// up to CLOCK_IDLE_TIMEOUT for UART, a busy one is retried on the next pass
+static uint8_t failsafeTask(TASK_Task *t)
+{
+	static uint32_t start;
+	static uint32_t lost;
+
+	TASK_BEGIN(t);
+
+	start = HAL_GetTick();
+
+	for(;;){
+		// Link up - first packet after boot or failsafe exit
+		TASK_WAIT_UNTIL(t, BUS_latest(&bus_link) != NULL || linkAge(start) > LINK_TIMEOUT);
+		TASK_WAIT_UNTIL(t, CLOCK_setProfile(CLOCK_PROFILE_PERFORMANCE) || linkAge(start) > LINK_TIMEOUT);
+
+		TASK_WAIT_UNTIL(t, linkAge(start) > LINK_TIMEOUT);
+
+		uint32_t outage = linkAge(start);
+		lost = HAL_GetTick() - outage;
+		failsafeEnter(outage);
+
+		TASK_WAIT_UNTIL(t, CLOCK_setProfile(CLOCK_PROFILE_LOW_POWER) || linkAge(start) <= LINK_TIMEOUT);
+
+		TASK_WAIT_UNTIL(t, linkAge(start) <= LINK_TIMEOUT);
+
+		FailsafeMsg *state = BUS_claim(&bus_failsafe);
+		state->active = 0;
+		state->outage = HAL_GetTick() - linkAge(start) - lost;
+		TRACE_event(TRACE_EVENT_FAILSAFE_EXIT, state->outage);
+		BUS_publish(&bus_failsafe);
+		TASK_signal(&logger_wake);
+	}
+
+	TASK_END(t);
+}
+
+// Every received frame, failsafe changes, link and loop frames every TELEMETRY_PERIOD
+static uint8_t loggerTask(TASK_Task *t)
+{
+	static BUS_Reader frames = BUS_READER(bus_control);
+	static BUS_Reader states = BUS_READER(bus_failsafe);
+	static uint32_t telemetry_last;
+
+	TASK_BEGIN(t);
+
+	telemetry_last = HAL_GetTick();
+
+	for(;;){
+		TASK_WAIT_EVENT(t, logger_wake);
+
+		const FailsafeMsg *state = BUS_read(&states);
+		const ControlMsg *frame = BUS_read(&frames);
+		const LinkMsg *link = BUS_latest(&bus_link);
+		if(state == NULL && frame == NULL)
+			continue;
+
+		PROFILER_BEGIN(PROFILER_ZONE_TELEMETRY);
+		if(state != NULL)
+			TELEMETRY_sendEvent(state->active ? TELEMETRY_EVENT_LINK_LOST : TELEMETRY_EVENT_LINK_UP, state->outage);
+		if(frame != NULL)
+			TELEMETRY_sendControl(frame->speed, frame->direction, TELEMETRY_CONTROL_ACKED);
+
+		if(link != NULL && (HAL_GetTick() - telemetry_last) >= TELEMETRY_PERIOD){
+			telemetry_last = HAL_GetTick();
+			TELEMETRY_sendLink(link->packets, link->packets);
+			TELEMETRY_sendLoop(link->loop_us, link->loop_us_max);
+		}
+		PROFILER_END(PROFILER_ZONE_TELEMETRY);
+	}
+
+	TASK_END(t);
+}
+
+// Host requests over USART2 RX
+static uint8_t commandTask(TASK_Task *t)
+{
+	static uint8_t command;
+
+	TASK_BEGIN(t);
+
+	for(;;){
+		TASK_WAIT_EVENT(t, command_ready);
+
+		while((command = LOGGER_getCommand()) != LOGGER_CMD_NONE){
+			switch(command){
+			case LOGGER_CMD_PROFILE:
+				PROFILER_report();
+				break;
+			case LOGGER_CMD_PROFILE_RESET:
+				PROFILER_reset();
+				break;
+			case LOGGER_CMD_MEMORY:
+				MEMSTAT_report();
+				break;
+			}
+		}
+	}
+
+	TASK_END(t);
+}
 /* USER CODE END 0 */
 
 /**
@@ -95,113 +360,66 @@ int main(void)
   MX_SPI2_Init();
   MX_TIM1_Init();
   /* USER CODE BEGIN 2 */
+  // Events exist before the interrupts signalling them are enabled
+  TASK_eventInit(&mixer_wake);
+  TASK_eventInit(&logger_wake);
+  TASK_eventInit(&radio_irq);
+  TASK_eventInit(&command_ready);
+
+  LOGGER_init(&huart2);
+#ifdef BENCHMARK
+  BENCH_suite();
+#endif
+  TELEMETRY_init(TELEMETRY_SOURCE_RX);
+  PROFILER_init();
+  TRACE_init(TRACE_SOURCE_RX);
   NRF24_init(&hspi2);
 
   HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
   HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_2);
 
-  HAL_GPIO_WritePin(GPIOC, GPIO_PIN_5, GPIO_PIN_RESET);
-  HAL_GPIO_WritePin(GPIOC, GPIO_PIN_6, GPIO_PIN_RESET);
-
-  TIM1->CCR1 = 0;
-  TIM1->CCR2 = 0;
+  MOTOR_apply(IDLE_STATE, IDLE_STATE);
 
   NRF24_openReadingPipe(1, rx_pipe_addr);
   NRF24_startListening();
 
-  uint32_t watchdog = HAL_GetTick();
-  uint8_t error_msg[] = "Connection Lost\r\n";
-  const uint32_t timeout = 1400;
+  // nRF24 IRQ wakes radioTask at RX_DR instead of a poll once per tick
+  GPIO_InitTypeDef radio_irq_pin = { .Pin = NRF24_IRQ_Pin, .Mode = GPIO_MODE_IT_FALLING, .Pull = GPIO_PULLUP };
+  HAL_GPIO_Init(NRF24_IRQ_GPIO_Port, &radio_irq_pin);
+  HAL_NVIC_SetPriority(NRF24_IRQ_EXTI_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(NRF24_IRQ_EXTI_IRQn);
+
+  // Sprint while packets arrive, drop to HSI in failsafe - PWM stays at 1 kHz
+  CLOCK_init();
+  CLOCK_addSpi(&hspi2);
+  CLOCK_addUart(&huart2);
+  CLOCK_addTimer(&htim1);
+
+#ifdef USE_FREERTOS
+  // Preemption levels from the .ioc, kernel masks 5 and below - EXTI signals the radio task,
+  // USART2 RX the command task
+  HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+  HAL_NVIC_SetPriority(NRF24_IRQ_EXTI_IRQn, 5, 0);
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 7, 0);
+  HAL_NVIC_SetPriority(USART2_IRQn, 7, 0);
+#endif
+
+  // Most urgent first - bare-metal runs them in this order, FreeRTOS by priority
+  static TASK_Task tasks[] = {
+	  TASK_INIT(radioTask, TASK_PRIORITY_RADIO),
+	  TASK_INIT(mixerTask, TASK_PRIORITY_CONTROL),
+	  TASK_INIT(failsafeTask, TASK_PRIORITY_CONTROL),
+	  TASK_INIT(loggerTask, TASK_PRIORITY_TELEMETRY),
+	  TASK_INIT(commandTask, TASK_PRIORITY_TELEMETRY),
+  };
+  TASK_start(tasks, sizeof(tasks) / sizeof(tasks[0]));
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-	  if(NRF24_available()){
-		  NRF24_read(my_rx_data, PAYLOAD_SIZE);
-
-		  my_rx_data[PAYLOAD_SIZE] = '\r';
-		  my_rx_data[PAYLOAD_SIZE + 1] = '\n';
-		  HAL_UART_Transmit(&huart2, my_rx_data, PAYLOAD_SIZE + 2, 100);
-
-		  if((my_rx_data[0] >= 40) && (my_rx_data[0] <= 60)){
-		  		// IDLE STATE - STOP
-		  		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_5, GPIO_PIN_RESET);
-		  		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_6, GPIO_PIN_RESET);
-		  		TIM1->CCR1 = 0;
-		  		TIM1->CCR2 = 0;
-		  	}
-		  	else if((my_rx_data[0] >= 0) && (my_rx_data[0] < 40)){
-		  		// SAIL BACKWARD
-		  		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_5, GPIO_PIN_RESET);
-		  		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_6, GPIO_PIN_SET);
-		  		if((my_rx_data[1] >= 40) && (my_rx_data[1] <= 60)){
-		  			// SAIL STRAIGHT
-		  			TIM1->CCR1 = my_rx_data[0];
-		  			TIM1->CCR2 = my_rx_data[0];
-		  		}
-		  		else if((my_rx_data[1] >= 0) && (my_rx_data[1] < 20)){
-		  			// SAIL FULL LEFT
-		  			TIM1->CCR1 = my_rx_data[0];
-		  			TIM1->CCR2 = 0;
-		  		}
-		  		else if((my_rx_data[1] >= 20) && (my_rx_data[1] < 40)){
-		  			// SAIL HALF LEFT
-		  			TIM1->CCR1 = my_rx_data[0];
-		  			TIM1->CCR2 = (uint8_t)(my_rx_data[0] / 2.0);
-		  		}
-		  		else if((my_rx_data[1] > 80) && (my_rx_data[1] <= 100)){
-		  			// SAIL FULL RIGHT
-		  			TIM1->CCR1 = 0;
-		  			TIM1->CCR2 = my_rx_data[0];
-		  		}
-		  		else if((my_rx_data[1] > 60) && (my_rx_data[1] <= 80)){
-		  			// SAIL HALF RIGHT
-		  			TIM1->CCR1 = (uint8_t)(my_rx_data[0] / 2.0);
-		  			TIM1->CCR2 = my_rx_data[0];
-		  		}
-		  	}
-		  	else if((my_rx_data[0] > 60) && (my_rx_data[0] <= 100)){
-		  		// SAIL FORWARD
-		  		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_5, GPIO_PIN_SET);
-		  		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_6, GPIO_PIN_RESET);
-		  		if((my_rx_data[1] >= 40) && (my_rx_data[1] <= 60)){
-		  			// SAIL STRAIGHT
-		  			TIM1->CCR1 = my_rx_data[0];
-		  			TIM1->CCR2 = my_rx_data[0];
-		  		}
-		  		else if((my_rx_data[1] >= 0) && (my_rx_data[1] < 20)){
-		  			// SAIL FULL LEFT
-		  			TIM1->CCR1 = 0;
-		  			TIM1->CCR2 = my_rx_data[0];
-		  		}
-		  		else if((my_rx_data[1] >= 20) && (my_rx_data[1] < 40)){
-		  			// SAIL HALF LEFT
-		  			TIM1->CCR1 = (uint8_t)(my_rx_data[0] / 2.0);
-		  			TIM1->CCR2 = my_rx_data[0];
-		  		}
-		  		else if((my_rx_data[1] > 80) && (my_rx_data[1] <= 100)){
-		  			// SAIL FULL RIGHT
-		  			TIM1->CCR1 = my_rx_data[0];
-		  			TIM1->CCR2 = 0;
-		  		}
-		  		else if((my_rx_data[1] > 60) && (my_rx_data[1] <= 80)){
-		  			// SAIL HALF RIGHT
-		  			TIM1->CCR1 = my_rx_data[0];
-		  			TIM1->CCR2 = (uint8_t)(my_rx_data[0] / 2.0);
-		  		}
-		  	}
-
-		  watchdog = HAL_GetTick();
-	  }
-	  else if((HAL_GetTick() - watchdog) > timeout ){
-		  my_rx_data[0] = IDLE_STATE;
-		  my_rx_data[1] = IDLE_STATE;
-		  HAL_UART_Transmit(&huart2, error_msg, sizeof(error_msg), 100);
-
-		  HAL_Delay(100);
-	  }
+	  TASK_schedule(tasks, sizeof(tasks) / sizeof(tasks[0]));
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -254,6 +472,27 @@ void SystemClock_Config(void)
 }
 
 /* USER CODE BEGIN 4 */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	LOGGER_txCplt(huart);
+}
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+	LOGGER_rxCplt(huart);
+	TASK_signal(&command_ready);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	LOGGER_error(huart);
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+	if(GPIO_Pin == NRF24_IRQ_Pin)
+		TASK_signal(&radio_irq);
+}
 
 /* USER CODE END 4 */
 
@@ -23,6 +23,14 @@
 #include "stm32f4xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "KK_TRACE.h"
+#ifdef USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+// GCC/ARM_CM4F port.c
+extern void xPortSysTickHandler(void);
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -58,6 +66,8 @@
 /* External variables --------------------------------------------------------*/
 
 /* USER CODE BEGIN EV */
+extern UART_HandleTypeDef huart2;
+extern DMA_HandleTypeDef hdma_usart2_tx;
 
 /* USER CODE END EV */
 
@@ -186,6 +196,10 @@ void SysTick_Handler(void)
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
+#ifdef USE_FREERTOS
+  if(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+    xPortSysTickHandler();
+#endif
 
   /* USER CODE END SysTick_IRQn 1 */
 }
@@ -198,6 +212,36 @@ void SysTick_Handler(void)
 /******************************************************************************/
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles DMA1 stream6 global interrupt (USART2_TX - logger).
+  */
+void DMA1_Stream6_IRQHandler(void)
+{
+  TRACE_IRQ_ENTER();
+  HAL_DMA_IRQHandler(&hdma_usart2_tx);
+  TRACE_IRQ_EXIT();
+}
+
+/**
+  * @brief This function handles USART2 global interrupt.
+  */
+void USART2_IRQHandler(void)
+{
+  TRACE_IRQ_ENTER();
+  HAL_UART_IRQHandler(&huart2);
+  TRACE_IRQ_EXIT();
+}
+
+/**
+  * @brief This function handles EXTI line[9:5] interrupts (nRF24 IRQ).
+  */
+void EXTI9_5_IRQHandler(void)
+{
+  TRACE_IRQ_ENTER();
+  HAL_GPIO_EXTI_IRQHandler(NRF24_IRQ_Pin);
+  TRACE_IRQ_EXIT();
+}
+
 
 /* USER CODE END 1 */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
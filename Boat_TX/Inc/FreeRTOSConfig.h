@@ -0,0 +1,91 @@
+/*
+Library for:				FreeRTOS kernel configuration - USE_FREERTOS build of KK_TASK
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- FreeRTOS Customisation (FreeRTOSConfig.h) reference
+							- FreeRTOS ARM_CM4F and Posix port demos
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Target:				STM32F446 with the GCC/ARM_CM4F port. SysTick is shared with HAL at 1 kHz
+					(KK_TASK overrides HAL_InitTick), SVC and PendSV come from a RAM vector table.
+Host:				without USE_HAL_DRIVER the same file configures the Posix port (Tools/tasksim),
+					a task stack there is the pthread stack and needs at least PTHREAD_STACK_MIN.
+*/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* Scheduler */
+
+#define configUSE_PREEMPTION					1
+#define configUSE_TIME_SLICING					0
+#define configUSE_IDLE_HOOK						0
+#define configUSE_TICK_HOOK						0
+#define configTICK_RATE_HZ						1000
+#define configMAX_TASK_NAME_LEN					16
+#define configUSE_16_BIT_TICKS					0
+#define configIDLE_SHOULD_YIELD					1
+
+/* Memory - tasks, stacks and semaphores are static, no heap_x.c is linked */
+
+#define configSUPPORT_STATIC_ALLOCATION			1
+#define configSUPPORT_DYNAMIC_ALLOCATION		0
+
+/* Features */
+
+#define configUSE_MUTEXES						0
+#define configUSE_COUNTING_SEMAPHORES			0
+#define configUSE_TASK_NOTIFICATIONS			1
+#define configQUEUE_REGISTRY_SIZE				0
+#define configCHECK_FOR_STACK_OVERFLOW			0
+#define configUSE_TRACE_FACILITY				0
+
+#define INCLUDE_vTaskDelay						1
+#define INCLUDE_vTaskDelayUntil					1
+#define INCLUDE_xTaskDelayUntil					1
+#define INCLUDE_vTaskDelete						1
+#define INCLUDE_xTaskGetSchedulerState			1
+#define INCLUDE_vTaskSuspend					1
+#define INCLUDE_uxTaskGetStackHighWaterMark		1
+
+#ifdef USE_HAL_DRIVER
+
+/* Cortex-M4F */
+
+#include <stdint.h>
+extern uint32_t SystemCoreClock;
+
+#define configCPU_CLOCK_HZ						SystemCoreClock
+#define configMAX_PRIORITIES					5			// idle + TASK_PRIORITY_TELEMETRY .. RADIO
+#define configMINIMAL_STACK_SIZE				128
+#define configUSE_TIMERS						0
+
+// 4 priority bits, NVIC_PRIORITYGROUP_4 - ISRs at 0 - 4 are never masked and must not call the kernel
+#define configPRIO_BITS							4
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY	15
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY	5
+#define configKERNEL_INTERRUPT_PRIORITY			(configLIBRARY_LOWEST_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY	(configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
+
+#define configASSERT(x)							do { if(! (x)){ taskDISABLE_INTERRUPTS(); for(;;); } } while(0)
+
+#else
+
+/* Posix port */
+
+#define configCPU_CLOCK_HZ						1000000
+#define configMAX_PRIORITIES					6			// timer task above RADIO stands in for interrupts
+#define configMINIMAL_STACK_SIZE				16384		// PTHREAD_STACK_MIN is not a constant in glibc 2.34+
+#define configUSE_TIMERS						1
+#define configTIMER_TASK_PRIORITY				(configMAX_PRIORITIES - 1)
+#define configTIMER_QUEUE_LENGTH				8
+#define configTIMER_TASK_STACK_DEPTH			configMINIMAL_STACK_SIZE
+
+#include <assert.h>
+#define configASSERT(x)							assert(x)
+
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+/*
+Library for:				On-target microbenchmarks - DWT cycle counter harness
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- ARMv7-M Architecture Reference Manual, C1.8 Data Watchpoint and Trace unit
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:				Build the "Benchmark" configuration (defines BENCHMARK), flash and capture USART2.
+					Board runs BENCH_suite() instead of the application and prints one line per benchmark:
+
+					bench_begin,<board>,<clockMHz>
+					bench,<board>,<name>,<iterations>,<min>,<mean>,<max>	(cycles, harness overhead removed)
+					bench_skip,<board>,<name>,<reason>
+					bench_end,<board>
+
+					Interrupts stay enabled - min and mean are stable, max includes SysTick and DMA handlers.
+					Tools/bench/kk_bench turns the capture into a table and compares it against a baseline.
+*/
+
+#ifndef KK_BENCH_H
+#define KK_BENCH_H
+
+/* Headers */
+
+#include "stm32f4xx_hal.h"
+
+#ifdef BENCHMARK
+
+/* Types */
+
+// Benchmarked operation, called once per iteration with iteration number
+typedef void (*BENCH_Function)(uint32_t iteration);
+
+/* Functions */
+
+void BENCH_init(const char *board);
+void BENCH_run(const char *name, BENCH_Function function, uint32_t iterations);
+void BENCH_skip(const char *name, const char *reason);
+void BENCH_end(void);
+
+// Board specific list of benchmarks (KK_BENCH_SUITE.c), never returns
+void BENCH_suite(void);
+
+#endif
+
+#endif
@@ -0,0 +1,83 @@
+/*
+Library for:				Message bus - static publish / subscribe without copies or locks
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Linux kernel seqcount / single-producer ring buffer pattern
+							- GCC __atomic builtins (release / acquire ordering)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:				A topic is BUS_SLOTS preallocated messages of one type and a sequence number.
+					The only producer fills the next slot in place and publishes it:
+
+						BUS_TOPIC(bus_control, ControlMsg);
+						ControlMsg *frame = BUS_claim(&bus_control);
+						frame->speed = ...;
+						BUS_publish(&bus_control);
+
+					Every consumer owns a BUS_Reader and gets a pointer into the slot - no copy, the
+					producer never waits for consumers and a new consumer is one more reader:
+
+						static BUS_Reader radio_control = BUS_READER(bus_control);
+						const ControlMsg *frame = BUS_read(&radio_control);	// NULL when nothing new
+
+					A consumer waits for a TASK_Event the producer signals after BUS_publish and then
+					reads - BUS_pending() as a TASK_WAIT_UNTIL condition would be checked only once per
+					tick with USE_FREERTOS. Consumers of state (display) take BUS_latest() and need no
+					reader.
+					A message stays untouched for the next BUS_SLOTS - 2 publishes; a consumer slower
+					than that checks BUS_valid() after using the message. Readers that fall behind
+					skip to the newest message and count the skipped ones in missed.
+					Producer may be an ISR, a reader belongs to one task.
+*/
+
+#ifndef KK_BUS_H
+#define KK_BUS_H
+
+/* Headers */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* General defines */
+
+#define BUS_FALSE					0x00
+#define BUS_TRUE					0x01
+
+/* Configuration */
+
+#define BUS_SLOTS					4			// per topic, power of 2
+
+/* Types */
+
+typedef struct
+{
+	void *slots;
+	uint16_t size;					// bytes per message
+	uint32_t seq;					// last published message, 0 - none yet
+} BUS_Topic;
+
+typedef struct
+{
+	BUS_Topic *topic;
+	uint32_t seq;					// sequence of the message returned by last BUS_read
+	uint32_t missed;				// messages published but never returned to this reader
+} BUS_Reader;
+
+/* Macros */
+
+#define BUS_TOPIC(name, type)		static type name##_slots[BUS_SLOTS]; \
+									static BUS_Topic name = { name##_slots, sizeof(type), 0 }
+#define BUS_READER(topic)			{ &(topic), 0, 0 }
+
+/* Functions */
+
+void *BUS_claim(BUS_Topic *topic);
+uint32_t BUS_publish(BUS_Topic *topic);
+const void *BUS_read(BUS_Reader *reader);
+uint8_t BUS_pending(const BUS_Reader *reader);
+const void *BUS_latest(const BUS_Topic *topic);
+uint8_t BUS_valid(const BUS_Reader *reader);
+
+#endif
@@ -0,0 +1,76 @@
+/*
+Library for:				Runtime clock profiles with peripheral retiming
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- RM0390 STM32F446xx Reference Manual, 5.1.4 Voltage regulator (over-drive),
+							  3.4.1 Relation between CPU clock frequency and Flash memory read time
+							- STM32F4 HAL RCC and PWREx drivers
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Profiles:			LOW_POWER		16 MHz HSI, PLL off, scale 3	APB1 16 MHz, APB2 16 MHz
+					DEFAULT			84 MHz PLL, scale 3				APB1 42 MHz, APB2 84 MHz (SystemClock_Config)
+					PERFORMANCE		180 MHz PLL, scale 1, over-drive	APB1 45 MHz, APB2 90 MHz
+
+Usage:				CLOCK_init() once after the MX_ inits and LOGGER_init, then CLOCK_addX() for every
+					peripheral whose bit rate depends on the bus clock. Registration remembers the rate
+					the peripheral runs at when it is added; CLOCK_setProfile() rewrites the dividers
+					so it stays there:
+					SPI		nearest BR power-of-two divider (rate is kept within a factor of 1.5)
+					I2C		HAL_I2C_Init recomputes FREQ, CCR and TRISE from Init.ClockSpeed
+					UART	BRR from Init.BaudRate, receive interrupt keeps running
+					TIM		PSC so the counter tick (and PWM frequency) is unchanged, from next update
+
+					Drivers that start transfers from interrupts register a hold function with
+					CLOCK_addHold() - it is called with CLOCK_TRUE before the idle wait and with
+					CLOCK_FALSE after retiming, queued transfers wait in between.
+					Switching waits until UART and I2C transfers finish and fails with CLOCK_FALSE
+					(clock untouched) when they do not in CLOCK_IDLE_TIMEOUT. The switch and retiming
+					run with the FreeRTOS scheduler suspended. SysTick is reprogrammed
+					by HAL, HAL_GetTick and TELEMETRY_timestamp keep their units; DWT cycle counts
+					change scale - a TELEMETRY_EVENT_CLOCK / TRACE_EVENT_CLOCK marks every switch.
+*/
+
+#ifndef KK_CLOCK_H
+#define KK_CLOCK_H
+
+/* Headers */
+
+#include "stm32f4xx_hal.h"
+
+/* Configuration */
+
+#define CLOCK_FALSE					0x00
+#define CLOCK_TRUE					0x01
+
+#define CLOCK_MAX_PERIPHERALS		4			// per peripheral type
+#define CLOCK_IDLE_TIMEOUT			50			// ms to wait for running transfers
+
+/* Profiles */
+
+#define CLOCK_PROFILE_LOW_POWER		0
+#define CLOCK_PROFILE_DEFAULT		1
+#define CLOCK_PROFILE_PERFORMANCE	2
+#define CLOCK_PROFILE_COUNT			3
+
+/* Types */
+
+typedef void (*CLOCK_HoldFunction)(uint8_t hold);
+
+/* Functions */
+
+void CLOCK_init(void);
+uint8_t CLOCK_addSpi(SPI_HandleTypeDef *hspi);
+uint8_t CLOCK_addUart(UART_HandleTypeDef *huart);
+#ifdef HAL_I2C_MODULE_ENABLED
+uint8_t CLOCK_addI2c(I2C_HandleTypeDef *hi2c);
+#endif
+#ifdef HAL_TIM_MODULE_ENABLED
+uint8_t CLOCK_addTimer(TIM_HandleTypeDef *htim);
+#endif
+uint8_t CLOCK_addHold(CLOCK_HoldFunction hold);
+uint8_t CLOCK_setProfile(uint8_t profile);
+uint8_t CLOCK_getProfile(void);
+
+#endif
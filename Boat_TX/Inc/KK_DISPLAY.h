@@ -0,0 +1,41 @@
+/*
+Library for:				Boat_TX display pages (LCD1602A)
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- KK_LCD1602A library
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#ifndef KK_DISPLAY_H
+#define KK_DISPLAY_H
+
+#include "stm32f4xx_hal.h"
+#include "KK_LCD1602A.h"
+
+/* Refresh timing [ms] */
+#define DISPLAY_REFRESH_PERIOD		200		// Capped refresh rate, independent of packet rate
+
+/* Pages - cycled with B1 */
+#define DISPLAY_PAGE_STICKS			0x00
+#define DISPLAY_PAGE_LINK			0x01
+#define DISPLAY_PAGE_RATE			0x02
+#define DISPLAY_PAGE_LOOP			0x03
+#define DISPLAY_PAGE_COUNT			0x04
+
+/* Values shown on pages - filled by main loop */
+typedef struct
+{
+	uint8_t speed;
+	uint8_t direction;
+	uint16_t linkHistory;		// Last 16 transmissions, 1 bit each, LSB newest
+	uint32_t packetsSent;
+	uint32_t packetsAcked;
+	uint32_t loopTime;			// Last main loop iteration without idle delay [ms]
+	uint32_t loopTimeMax;
+} DISPLAY_Telemetry;
+
+void DISPLAY_init(void);
+void DISPLAY_nextPage(void);
+void DISPLAY_process(const DISPLAY_Telemetry *telemetry);
+
+#endif
@@ -0,0 +1,26 @@
+/*
+Library for:				Joystick ADC conversion
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32F446RE Reference Manual (ADC, 12-bit)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#include "stm32f4xx_hal.h"
+
+#ifndef KK_JOYSTICK_H
+#define KK_JOYSTICK_H
+
+/* Calibration */
+#define JOYSTICK_ADC_MAX			4095.0
+#define JOYSTICK_OFFSET				43			// percent read at the mechanical stop of the stick
+
+/* Functions */
+
+// Raw 12-bit sample to the 0 - 100 percent range sent to the boat (50 is centre)
+static inline uint8_t JOYSTICK_toPercent(uint16_t raw){
+	uint8_t percent = (uint8_t)((raw * 100.0) / JOYSTICK_ADC_MAX);
+	return (uint8_t)((percent - JOYSTICK_OFFSET) * (100.0 / (100 - JOYSTICK_OFFSET)));
+}
+
+#endif /* KK_JOYSTICK_H */
@@ -5,13 +5,11 @@ Based on:					- HD44780U Datasheet
 							- PCF8574 Datasheet
 							- Mohamed Yaqoob's STM32 Tutorials
 First update:				26/12/2020
-Last update:				27/12/2020
+Last update:				18/10/2026
 */
 
 #include "stm32f4xx_hal.h"
-#include <stdio.h>
 #include <string.h>
-#include <stdarg.h>
 
 #ifndef KK_LCD1602A_H
 #define KK_LCD1602A_H
@@ -51,9 +49,93 @@ Last update:				27/12/2020
 #define LCD_I2C_SLAVE_ADDRESS_0  	0x4E
 #define LCD_I2C_SLAVE_ADDRESS_1  	0x7E
 
+// Fixed backpack address (8-bit, PCF8574 0x40 - 0x4E or PCF8574A 0x70 - 0x7E), 0 - probe both above
+#ifndef LCD_I2C_ADDRESS
+#define LCD_I2C_ADDRESS				0
+#endif
+
+_Static_assert(LCD_I2C_ADDRESS == 0 || (!(LCD_I2C_ADDRESS & 0x01) && ((LCD_I2C_ADDRESS >= 0x40 && LCD_I2C_ADDRESS <= 0x4E) ||
+	(LCD_I2C_ADDRESS >= 0x70 && LCD_I2C_ADDRESS <= 0x7E))), "LCD_I2C_ADDRESS is not a PCF8574 write address");
+
+/* Display geometry */
+#define LCD_ROWS					2
+#define LCD_COLS					16
+
+/* I2C bus pins - used for bus recovery (checked by PIN_ASSERT) */
+#define LCD_SCL_GPIO_Port			GPIOB
+#define LCD_SCL_Pin					GPIO_PIN_6
+#define LCD_SDA_GPIO_Port			GPIOB
+#define LCD_SDA_Pin					GPIO_PIN_7
+
+/* Device state */
+#define LCD_STATE_ABSENT			0x00	// Not answering, probed every LCD_PROBE_PERIOD
+#define LCD_STATE_PROBING			0x01	// Probe transfer in flight
+#define LCD_STATE_FOUND				0x02	// Probe acknowledged, init not queued yet
+#define LCD_STATE_PRESENT			0x03
+#define LCD_STATE_FAULT				0x04	// Bus error or stuck transfer, bus needs recovery
+
+/* Time limits [ms] */
+#define LCD_I2C_TIMEOUT				5		// Blocking transfers (init)
+#define LCD_TRANSFER_TIMEOUT		20		// DMA transfer, longest segment takes ~8 ms at 100 kHz
+#define LCD_PROBE_PERIOD			500		// Background probing of absent LCD
+
+/* Custom glyphs (CGRAM) */
+#define LCD_GLYPH_WIDTH				5
+#define LCD_GLYPH_BAR_1				0x01	// Bar glyphs with 1 - 4 lit columns use codes 0x01 - 0x04
+#define LCD_GLYPH_FULL				0xFF	// Full block from character ROM
+
+/* I2C bus speed - PCF8574 is specified for 100 kHz, most backpacks work in 400 kHz fast mode */
+#define LCD_I2C_FAST_MODE			FALSE
+
+#if LCD_I2C_FAST_MODE
+#define LCD_I2C_CLOCK_SPEED			400000
+#else
+#define LCD_I2C_CLOCK_SPEED			100000
+#endif
+
+/* PCF8574 byte stream timing (HD44780U datasheet page 52 and 58) */
+#define LCD_I2C_BYTE_NS				(9 * (1000000000 / LCD_I2C_CLOCK_SPEED))	// 8 bits + ACK per output change
+#define LCD_EXEC_TIME_NS			37000										// Execution time of a write
+#define LCD_EN_PULSE_NS				450											// Minimal enable pulse width
+#define LCD_PAD_BYTES				((LCD_EXEC_TIME_NS + LCD_I2C_BYTE_NS - 1) / LCD_I2C_BYTE_NS - 1)
+#define LCD_BYTES_PER_WRITE			(4 + LCD_PAD_BYTES)
+
+_Static_assert(LCD_I2C_BYTE_NS >= LCD_EN_PULSE_NS, "EN pulse shorter than HD44780 minimum");
+_Static_assert((1 + LCD_PAD_BYTES) * LCD_I2C_BYTE_NS >= LCD_EXEC_TIME_NS, "Next write starts before HD44780 finished");
+
+/* Busy flag polling in blocking mode (init), RW is PCF8574 P1 (LCD_RW) - init reads BF once after
+   function set and falls back to fixed delays if the readback is invalid (RW tied to GND, bus error) */
+#ifndef LCD_USE_BUSY_FLAG
+#define LCD_USE_BUSY_FLAG			TRUE
+#endif
+
+/* Asynchronous transport */
+#define LCD_QUEUE_SIZE				8		// Queued I2C transactions, power of 2
+#define LCD_SEGMENT_SIZE			(LCD_BYTES_PER_WRITE * (LCD_COLS + 1))	// Cursor move and a whole line
+
 uint8_t LCD1602A_init(I2C_HandleTypeDef *pI2cHandle);
 void LCD1602A_setCursor(uint8_t row, uint8_t col);
 void LCD1602A_clear(void);
-void LCD1602A_printf(const char* str, ...);
+void LCD1602A_print(const char* str);
+
+/* Framebuffer functions */
+void LCD1602A_fbClear(void);
+uint8_t LCD1602A_fbPutString(uint8_t row, uint8_t col, const char* str);
+uint8_t LCD1602A_fbPutUint(uint8_t row, uint8_t col, uint32_t value, uint8_t width);
+uint8_t LCD1602A_fbPutBar(uint8_t row, uint8_t col, uint8_t cells, uint32_t value, uint32_t max);
+void LCD1602A_flush(void);
+
+/* Custom glyph functions */
+uint8_t LCD1602A_loadGlyph(uint8_t slot, const uint8_t pattern[8]);
+
+/* Asynchronous transport functions */
+uint8_t LCD1602A_isIdle(void);
+void LCD1602A_pause(uint8_t pause);
+uint8_t LCD1602A_hasBusyFlag(void);
+void LCD1602A_tick(void);
+void LCD1602A_txCplt(I2C_HandleTypeDef *hi2c);
+void LCD1602A_txError(I2C_HandleTypeDef *hi2c);
+void LCD1602A_process(void);
+uint8_t LCD1602A_getState(void);
 
 #endif
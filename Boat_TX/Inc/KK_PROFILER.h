@@ -0,0 +1,124 @@
+/*
+Library for:				Cycle profiler - DWT cycle counter zones
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- ARMv7-M Architecture Reference Manual, C1.8 Data Watchpoint and Trace unit
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:				PROFILER_SCOPE(PROFILER_ZONE_x);		// until end of enclosing block
+					PROFILER_BEGIN(PROFILER_ZONE_x); ... PROFILER_END(PROFILER_ZONE_x);
+
+					Zones are accumulated without locking - profile every zone from one context only.
+					Whole module compiles out when PROFILER_ENABLED is 0 (default outside DEBUG builds).
+*/
+
+#ifndef KK_PROFILER_H
+#define KK_PROFILER_H
+
+/* Headers */
+
+#include "stm32f4xx_hal.h"
+
+/* Configuration */
+
+#ifndef PROFILER_ENABLED
+#ifdef DEBUG
+#define PROFILER_ENABLED			1
+#else
+#define PROFILER_ENABLED			0
+#endif
+#endif
+
+// Histogram bucket i holds samples of [2^(i+SHIFT), 2^(i+SHIFT+1)) cycles, first and last are open
+#define PROFILER_BUCKETS			16
+#define PROFILER_BUCKET_SHIFT		8
+
+/* Zones - shared by both boards, host tool keeps the same names */
+
+typedef enum
+{
+	PROFILER_ZONE_LOOP = 0,
+	PROFILER_ZONE_NRF24_WRITE_START,
+	PROFILER_ZONE_NRF24_AVAILABLE,
+	PROFILER_ZONE_NRF24_READ,
+	PROFILER_ZONE_DISPLAY,
+	PROFILER_ZONE_MIXING,
+	PROFILER_ZONE_TELEMETRY,
+	PROFILER_ZONE_NRF24_WRITE_FINISH,	// Appended - ids of older zones stay valid in existing logs
+	PROFILER_ZONE_COUNT
+} PROFILER_ZoneId;
+
+#if PROFILER_ENABLED
+
+/* Types */
+
+typedef struct
+{
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t histogram[PROFILER_BUCKETS];
+} PROFILER_Zone;
+
+typedef struct
+{
+	uint8_t zone;
+	uint32_t start;
+} PROFILER_Scope;
+
+extern PROFILER_Zone PROFILER_zones[PROFILER_ZONE_COUNT];
+
+/* Functions */
+
+void PROFILER_init(void);
+void PROFILER_reset(void);
+void PROFILER_report(void);
+
+// Inline so a zone costs two counter reads and a handful of ALU operations
+static inline void PROFILER_record(uint8_t zone, uint32_t cycles)
+{
+	PROFILER_Zone *z = &PROFILER_zones[zone];
+	uint32_t bucket = (cycles >> PROFILER_BUCKET_SHIFT) ? 32 - __CLZ(cycles >> PROFILER_BUCKET_SHIFT) : 0;
+
+	if(bucket >= PROFILER_BUCKETS)
+		bucket = PROFILER_BUCKETS - 1;
+
+	z->count++;
+	z->sum += cycles;
+	if(cycles < z->min)
+		z->min = cycles;
+	if(cycles > z->max)
+		z->max = cycles;
+	z->histogram[bucket]++;
+}
+
+static inline void PROFILER_scopeEnd(PROFILER_Scope *scope)
+{
+	PROFILER_record(scope->zone, DWT->CYCCNT - scope->start);
+}
+
+/* Macros */
+
+#define PROFILER_CONCAT_(a, b)		a##b
+#define PROFILER_CONCAT(a, b)		PROFILER_CONCAT_(a, b)
+
+#define PROFILER_SCOPE(zone)		PROFILER_Scope PROFILER_CONCAT(profiler_scope_, __LINE__) \
+										__attribute__((cleanup(PROFILER_scopeEnd))) = { (zone), DWT->CYCCNT }
+#define PROFILER_BEGIN(zone)		uint32_t profiler_start_##zone = DWT->CYCCNT
+#define PROFILER_END(zone)			PROFILER_record((zone), DWT->CYCCNT - profiler_start_##zone)
+
+#else
+
+#define PROFILER_init()				((void)0)
+#define PROFILER_reset()			((void)0)
+#define PROFILER_report()			((void)0)
+#define PROFILER_SCOPE(zone)		((void)0)
+#define PROFILER_BEGIN(zone)		((void)0)
+#define PROFILER_END(zone)			((void)0)
+
+#endif
+
+#endif
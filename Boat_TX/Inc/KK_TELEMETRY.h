@@ -0,0 +1,82 @@
+/*
+Library for:				Binary telemetry over KK_LOGGER (COBS framing)
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- S. Cheshire, M. Baker - Consistent Overhead Byte Stuffing
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Frame on the wire:	COBS( type | seq | timestamp[4] | payload[n] | crc16[2] ) 0x00
+					- multi-byte fields little endian
+					- timestamp in microseconds since boot (wraps after ~71 minutes)
+					- seq incremented per frame, gaps mean frames dropped by logger
+					- crc16 CCITT-FALSE (poly 0x1021, init 0xFFFF) over type .. payload
+
+Payloads:			CONTROL		speed[1] direction[1] flags[1]
+					LINK		packets[4] acked[4] logDropped[4]
+					LOOP		loopTime[4] loopTimeMax[4] (microseconds)
+					EVENT		event[1] arg[4]
+					PROFILE		zone[1] clockMHz[1] count[4] min[4] max[4] mean[4] histogram[16][2] (cycles)
+					MEMORY		static[4] heapUsed[4] heapReserved[4] stackUsed[4] stackReserved[4] free[4] (bytes)
+					STACK		task[1] stackUsed[4] stackReserved[4] name[12] (bytes, FreeRTOS build, per task)
+*/
+
+#ifndef KK_TELEMETRY_H
+#define KK_TELEMETRY_H
+
+/* Headers */
+
+#include "stm32f4xx_hal.h"
+#include "KK_LOGGER.h"
+
+/* General defines */
+
+#define TELEMETRY_DELIMITER			0x00
+#define TELEMETRY_HEADER_SIZE		0x06
+#define TELEMETRY_MAX_PAYLOAD		0x40
+#define TELEMETRY_MAX_FRAME			(TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_PAYLOAD + 2)
+
+/* Sources (BOOT event argument) */
+
+#define TELEMETRY_SOURCE_TX			0x01
+#define TELEMETRY_SOURCE_RX			0x02
+
+/* Record types */
+
+#define TELEMETRY_TYPE_CONTROL		0x01
+#define TELEMETRY_TYPE_LINK			0x02
+#define TELEMETRY_TYPE_LOOP			0x03
+#define TELEMETRY_TYPE_EVENT		0x04
+#define TELEMETRY_TYPE_PROFILE		0x05
+#define TELEMETRY_TYPE_MEMORY		0x06
+#define TELEMETRY_TYPE_STACK		0x07
+
+#define TELEMETRY_PROFILE_SIZE		50
+#define TELEMETRY_MEMORY_SIZE		24
+#define TELEMETRY_STACK_SIZE		21
+#define TELEMETRY_STACK_NAME		12		// zero padded, longer task names are cut
+
+/* CONTROL flags */
+
+#define TELEMETRY_CONTROL_ACKED		0x01	// TX - packet acknowledged, RX - packet received
+
+/* Events */
+
+#define TELEMETRY_EVENT_BOOT		0x01	// arg - source
+#define TELEMETRY_EVENT_LINK_LOST	0x02	// arg - ms since last packet
+#define TELEMETRY_EVENT_LINK_UP		0x03	// arg - ms without link
+#define TELEMETRY_EVENT_LCD_MISSING	0x04
+#define TELEMETRY_EVENT_CLOCK		0x05	// arg - HCLK in MHz after KK_CLOCK profile switch
+
+/* Functions */
+
+void TELEMETRY_init(uint8_t source);
+uint32_t TELEMETRY_timestamp(void);
+uint8_t TELEMETRY_send(uint8_t type, const uint8_t *payload, uint8_t len);
+uint8_t TELEMETRY_sendControl(uint8_t speed, uint8_t direction, uint8_t flags);
+uint8_t TELEMETRY_sendLink(uint32_t packets, uint32_t acked);
+uint8_t TELEMETRY_sendLoop(uint32_t loopTime, uint32_t loopTimeMax);
+uint8_t TELEMETRY_sendEvent(uint8_t event, uint32_t arg);
+
+#endif
@@ -0,0 +1,110 @@
+/*
+Library for:				Event trace over ITM stimulus ports (SWO pin PB3)
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- ARMv7-M Architecture Reference Manual, Appendix D4 Debug ITM and DWT Packet Protocol
+							- RM0390 STM32F446xx Reference Manual, 33.14 TPIU
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Text (stdout) goes to port TRACE_PORT_TEXT byte by byte.
+Every event is two 32-bit stimulus writes, time first:
+					port TRACE_PORT_TIME	DWT->CYCCNT
+					port TRACE_PORT_EVENT	event[31:24] arg[23:0]
+
+Events are dropped (not waited for) when ITM is disabled or its FIFO is full, so trace never
+stalls the application. SWO runs NRZ at TRACE_SWO_BAUD, host decoder is Tools/swo (kk_swo).
+Whole module compiles out when TRACE_ENABLED is 0 (default outside DEBUG builds).
+*/
+
+#ifndef KK_TRACE_H
+#define KK_TRACE_H
+
+/* Headers */
+
+#include "stm32f4xx_hal.h"
+
+/* Configuration */
+
+#ifndef TRACE_ENABLED
+#ifdef DEBUG
+#define TRACE_ENABLED				1
+#else
+#define TRACE_ENABLED				0
+#endif
+#endif
+
+#define TRACE_SWO_BAUD				2000000		// HCLK must divide evenly - 16, 84 and 180 MHz (KK_CLOCK) do
+#define TRACE_PORT_TEXT				0
+#define TRACE_PORT_TIME				1
+#define TRACE_PORT_EVENT			2
+
+/* Events - shared by both boards, host decoder keeps the same names */
+
+#define TRACE_EVENT_SYNC			0x01		// arg - TRACE_SOURCE_x, once at init
+#define TRACE_EVENT_IRQ_ENTER		0x02		// arg - exception number (IPSR)
+#define TRACE_EVENT_IRQ_EXIT		0x03
+#define TRACE_EVENT_TASK_START		0x04		// arg - PROFILER_ZoneId
+#define TRACE_EVENT_TASK_STOP		0x05
+#define TRACE_EVENT_RADIO_TX		0x06		// arg - speed << 16 | direction << 8 | sequence
+#define TRACE_EVENT_RADIO_TX_DONE	0x07		// arg - 1 acknowledged, 0 lost
+#define TRACE_EVENT_RADIO_RX		0x08		// arg - speed << 16 | direction << 8 | sequence
+#define TRACE_EVENT_FAILSAFE_ENTER	0x09		// arg - ms since last packet
+#define TRACE_EVENT_FAILSAFE_EXIT	0x0A		// arg - ms without link
+#define TRACE_EVENT_SPI_BEGIN		0x0B		// NRF24 CSN low
+#define TRACE_EVENT_SPI_END			0x0C		// NRF24 CSN high
+#define TRACE_EVENT_I2C_BEGIN		0x0D		// arg - LCD DMA frame length
+#define TRACE_EVENT_I2C_END			0x0E		// arg - 1 done, 0 error
+#define TRACE_EVENT_CLOCK			0x0F		// arg - new HCLK in MHz, CYCCNT rate from here on
+
+#define TRACE_SOURCE_TX				0x01
+#define TRACE_SOURCE_RX				0x02
+
+#if TRACE_ENABLED
+
+/* Functions */
+
+void TRACE_init(uint8_t source);
+void TRACE_retime(void);
+uint8_t TRACE_write(const char *text, int len);
+
+// Inline so an event costs two FIFO checks and two stores
+static inline void TRACE_event(uint8_t event, uint32_t arg)
+{
+	if(!(ITM->TCR & ITM_TCR_ITMENA_Msk) || !(ITM->TER & (1UL << TRACE_PORT_EVENT)))
+		return;
+
+	// Time and event must stay adjacent in FIFO, interrupts may trace too
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(ITM->PORT[TRACE_PORT_TIME].u32)
+	{
+		ITM->PORT[TRACE_PORT_TIME].u32 = DWT->CYCCNT;
+		// Ports share one FIFO - the ready bit above only promised a single slot, so the event
+		// waits for the next one (one stimulus word on SWO) instead of being lost after its time
+		while(!ITM->PORT[TRACE_PORT_EVENT].u32);
+		ITM->PORT[TRACE_PORT_EVENT].u32 = ((uint32_t)event << 24) | (arg & 0x00FFFFFF);
+	}
+	__set_PRIMASK(primask);
+}
+
+/* Macros */
+
+#define TRACE_RADIO_ARG(payload)	(((uint32_t)(payload)[0] << 16) | ((uint32_t)(payload)[1] << 8) | (payload)[2])
+#define TRACE_IRQ_ENTER()			TRACE_event(TRACE_EVENT_IRQ_ENTER, __get_IPSR())
+#define TRACE_IRQ_EXIT()			TRACE_event(TRACE_EVENT_IRQ_EXIT, __get_IPSR())
+
+#else
+
+#define TRACE_init(source)			((void)0)
+#define TRACE_retime()				((void)0)
+#define TRACE_write(text, len)		0
+#define TRACE_event(event, arg)		((void)0)
+#define TRACE_RADIO_ARG(payload)	0
+#define TRACE_IRQ_ENTER()			((void)0)
+#define TRACE_IRQ_EXIT()			((void)0)
+
+#endif
+
+#endif
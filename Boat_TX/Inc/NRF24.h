@@ -22,9 +22,26 @@ Last update:				08/01/2021
 #define LOW						0x00
 #define HIGH					0x01
 
-#define PAYLOAD_SIZE			0x02
+#define PAYLOAD_SIZE			0x03		// speed, direction, sequence
 #define MAX_PAYLOAD_SIZE		0x20
 
+/* SPI configuration */
+
+// 1 - register transfers (SPI DR polling, BSRR pin writes), 0 - HAL_SPI / HAL_GPIO calls.
+// Benchmark build with NRF24_USE_LL=0 saved by kk_bench -w and compared with -c gives the
+// per-transaction cycles of both paths at the same SPI clock
+#ifndef NRF24_USE_LL
+#define NRF24_USE_LL			1
+#endif
+
+#define NRF24_SPI_MAX_HZ		10000000	// SCK limit of nRF24L01+, NRF24_init picks fastest divider below
+
+/* TX timing */
+
+// Longest wait for TX_DS / MAX_RT after NRF24_writeStart in ms - power-up from power down
+// (Tpd2stby up to 1.5 ms), standby to TX (130 us) and the packet on air, auto-ack is off
+#define NRF24_TX_TIMEOUT		3
+
 /* SPI Commands (46 page in the datasheet) */
 
 #define CMD_R_REGISTER    		0x00
@@ -190,8 +207,13 @@ void NRF24_init(SPI_HandleTypeDef *nrfSPI);
 void NRF24_openWritingPipe(uint64_t address);
 void NRF24_openReadingPipe(uint8_t number, uint64_t address);
 uint8_t NRF24_write(const void* buf, uint8_t len);
+void NRF24_writeStart(const void* buf, uint8_t len);
+uint8_t NRF24_writeDone(void);
+uint8_t NRF24_writeFinish(void);
 uint8_t NRF24_read(void* buf, uint8_t len);
 void NRF24_startListening(void);
 uint8_t NRF24_available(void);
+uint8_t NRF24_readRegister(uint8_t reg);
+void NRF24_writeRegister(uint8_t reg, uint8_t value);
 
 #endif
@@ -0,0 +1,178 @@
+/*
+Library for:				On-target microbenchmarks - DWT cycle counter harness
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- ARMv7-M Architecture Reference Manual, C1.8 Data Watchpoint and Trace unit
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_BENCH.h"
+
+#ifdef BENCHMARK
+
+#include "KK_LOGGER.h"
+#include <string.h>
+
+/* Private defines */
+
+#define BENCH_LINE_SIZE				96
+
+/* Private variables */
+
+static const char *bench_board = "";
+
+// Cycles of a run with an empty function, subtracted from every sample
+static uint32_t bench_overhead = 0;
+
+/* Static function prototypes */
+
+static void BENCH_empty(uint32_t iteration);
+static uint8_t BENCH_append(char *line, uint8_t pos, const char *str);
+static uint8_t BENCH_appendUint(char *line, uint8_t pos, uint32_t value);
+static void BENCH_print(char *line, uint8_t pos);
+
+/* Functions */
+
+static void BENCH_empty(uint32_t iteration)
+{
+	__asm volatile ("" : : "r" (iteration) : "memory");
+}
+
+static uint8_t BENCH_append(char *line, uint8_t pos, const char *str)
+{
+	while(*str != '\0' && pos < BENCH_LINE_SIZE - 2)
+		line[pos++] = *str++;
+
+	return pos;
+}
+
+static uint8_t BENCH_appendUint(char *line, uint8_t pos, uint32_t value)
+{
+	char digits[10];
+	uint8_t count = 0;
+
+	do
+	{
+		digits[count++] = (char)('0' + value % 10);
+		value /= 10;
+	} while(value);
+
+	while(count && pos < BENCH_LINE_SIZE - 2)
+		line[pos++] = digits[--count];
+
+	return pos;
+}
+
+// Terminate line and send it out completely, so UART DMA does not run during next benchmark
+static void BENCH_print(char *line, uint8_t pos)
+{
+	line[pos++] = '\r';
+	line[pos++] = '\n';
+
+	while(! LOGGER_isIdle());
+	LOGGER_write(line, pos);
+	while(! LOGGER_isIdle());
+}
+
+// Benchmark Initialization function - starts cycle counter, measures harness overhead and prints header
+void BENCH_init(const char *board)
+{
+	char line[BENCH_LINE_SIZE];
+	uint8_t pos;
+
+	bench_board = board;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	bench_overhead = UINT32_MAX;
+	for(uint32_t i = 0; i < 64; i++)
+	{
+		uint32_t start = DWT->CYCCNT;
+		BENCH_empty(i);
+		uint32_t cycles = DWT->CYCCNT - start;
+
+		if(cycles < bench_overhead)
+			bench_overhead = cycles;
+	}
+
+	pos = BENCH_append(line, 0, "bench_begin,");
+	pos = BENCH_append(line, pos, bench_board);
+	pos = BENCH_append(line, pos, ",");
+	pos = BENCH_appendUint(line, pos, SystemCoreClock / 1000000);
+	BENCH_print(line, pos);
+}
+
+// Run function iterations times, each call timed separately
+void BENCH_run(const char *name, BENCH_Function function, uint32_t iterations)
+{
+	char line[BENCH_LINE_SIZE];
+	uint8_t pos;
+	uint32_t min = UINT32_MAX;
+	uint32_t max = 0;
+	uint64_t sum = 0;
+
+	if(iterations == 0)
+		return;
+
+	// Warm up caches and peripheral state, not counted
+	function(0);
+
+	for(uint32_t i = 0; i < iterations; i++)
+	{
+		uint32_t start = DWT->CYCCNT;
+		function(i);
+		uint32_t cycles = DWT->CYCCNT - start;
+
+		cycles = cycles > bench_overhead ? cycles - bench_overhead : 0;
+		if(cycles < min)
+			min = cycles;
+		if(cycles > max)
+			max = cycles;
+		sum += cycles;
+	}
+
+	pos = BENCH_append(line, 0, "bench,");
+	pos = BENCH_append(line, pos, bench_board);
+	pos = BENCH_append(line, pos, ",");
+	pos = BENCH_append(line, pos, name);
+	pos = BENCH_append(line, pos, ",");
+	pos = BENCH_appendUint(line, pos, iterations);
+	pos = BENCH_append(line, pos, ",");
+	pos = BENCH_appendUint(line, pos, min);
+	pos = BENCH_append(line, pos, ",");
+	pos = BENCH_appendUint(line, pos, (uint32_t)(sum / iterations));
+	pos = BENCH_append(line, pos, ",");
+	pos = BENCH_appendUint(line, pos, max);
+	BENCH_print(line, pos);
+}
+
+// Benchmark that cannot run on this board (missing peripheral) - host reports it instead of a result
+void BENCH_skip(const char *name, const char *reason)
+{
+	char line[BENCH_LINE_SIZE];
+	uint8_t pos;
+
+	pos = BENCH_append(line, 0, "bench_skip,");
+	pos = BENCH_append(line, pos, bench_board);
+	pos = BENCH_append(line, pos, ",");
+	pos = BENCH_append(line, pos, name);
+	pos = BENCH_append(line, pos, ",");
+	pos = BENCH_append(line, pos, reason);
+	BENCH_print(line, pos);
+}
+
+void BENCH_end(void)
+{
+	char line[BENCH_LINE_SIZE];
+	uint8_t pos;
+
+	pos = BENCH_append(line, 0, "bench_end,");
+	pos = BENCH_append(line, pos, bench_board);
+	BENCH_print(line, pos);
+}
+
+#endif
@@ -0,0 +1,150 @@
+/*
+Library for:				On-target microbenchmarks - remote controller suite
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- KK_BENCH harness
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_BENCH.h"
+
+#ifdef BENCHMARK
+
+#include "spi.h"
+#include "i2c.h"
+#include "NRF24.h"
+#include "KK_LCD1602A.h"
+#include "KK_JOYSTICK.h"
+#include "KK_TELEMETRY.h"
+
+/* Private defines */
+
+#define BENCH_ITERATIONS			1000
+#define BENCH_ITERATIONS_RADIO		100			// every write without receiver waits for all retransmits
+#define BENCH_ITERATIONS_LCD		50
+#define BENCH_ITERATIONS_TELEMETRY	64			// frames that fit into logger buffer without draining
+
+/* Private variables */
+
+static const uint64_t bench_pipe_addr = 0x11223344AA;
+static uint8_t bench_rf_ch;
+static uint8_t bench_payload[MAX_PAYLOAD_SIZE];
+static volatile uint32_t bench_sink;
+
+/* Static function prototypes */
+
+static void BENCH_nrf24ReadRegister(uint32_t iteration);
+static void BENCH_nrf24WriteRegister(uint32_t iteration);
+static void BENCH_nrf24Write(uint32_t iteration);
+static void BENCH_lcdWait(void);
+static void BENCH_lcdChar(uint32_t iteration);
+static void BENCH_lcdLine(uint32_t iteration);
+static void BENCH_lcdFrame(uint32_t iteration);
+static void BENCH_joystick(uint32_t iteration);
+static void BENCH_telemetryControl(uint32_t iteration);
+
+/* Benchmarks */
+
+static void BENCH_nrf24ReadRegister(uint32_t iteration)
+{
+	bench_sink = NRF24_readRegister(REG_CONFIG);
+}
+
+// Writes back current channel - same SPI traffic, radio setup unchanged
+static void BENCH_nrf24WriteRegister(uint32_t iteration)
+{
+	NRF24_writeRegister(REG_RF_CH, bench_rf_ch);
+}
+
+// Whole transmission as the application does it, acknowledged only when receiver is powered
+static void BENCH_nrf24Write(uint32_t iteration)
+{
+	bench_payload[2] = (uint8_t)iteration;
+	bench_sink = NRF24_write(bench_payload, PAYLOAD_SIZE);
+}
+
+// Until last byte is on the display, gives up when display disappears
+static void BENCH_lcdWait(void)
+{
+	while(! LCD1602A_isIdle() && LCD1602A_getState() == LCD_STATE_PRESENT);
+}
+
+// Content alternates between iterations so every flush has cells to send
+static void BENCH_lcdChar(uint32_t iteration)
+{
+	LCD1602A_fbPutString(0, 0, (iteration & 1) ? "#" : "*");
+	LCD1602A_flush();
+	BENCH_lcdWait();
+}
+
+static void BENCH_lcdLine(uint32_t iteration)
+{
+	LCD1602A_fbPutString(0, 0, (iteration & 1) ? "################" : "****************");
+	LCD1602A_flush();
+	BENCH_lcdWait();
+}
+
+static void BENCH_lcdFrame(uint32_t iteration)
+{
+	const char *line = (iteration & 1) ? "################" : "****************";
+
+	LCD1602A_fbPutString(0, 0, line);
+	LCD1602A_fbPutString(1, 0, line);
+	LCD1602A_flush();
+	BENCH_lcdWait();
+}
+
+// Both axes of one ADC snapshot, raw value sweeps the 12-bit range
+static void BENCH_joystick(uint32_t iteration)
+{
+	uint16_t raw = (uint16_t)((iteration * 41) & 0x0FFF);
+
+	bench_sink = JOYSTICK_toPercent(raw) + JOYSTICK_toPercent(0x0FFF - raw);
+}
+
+// Framing and copy into logger buffer only, UART DMA runs in background
+static void BENCH_telemetryControl(uint32_t iteration)
+{
+	TELEMETRY_sendControl((uint8_t)iteration, 50, TELEMETRY_CONTROL_ACKED);
+}
+
+/* Functions */
+
+void BENCH_suite(void)
+{
+	BENCH_init("TX");
+
+	TELEMETRY_init(TELEMETRY_SOURCE_TX);
+	NRF24_init(&hspi2);
+	NRF24_openWritingPipe(bench_pipe_addr);
+	bench_rf_ch = NRF24_readRegister(REG_RF_CH);
+
+	BENCH_run("nrf24_read_register", BENCH_nrf24ReadRegister, BENCH_ITERATIONS);
+	BENCH_run("nrf24_write_register", BENCH_nrf24WriteRegister, BENCH_ITERATIONS);
+	BENCH_run("nrf24_write", BENCH_nrf24Write, BENCH_ITERATIONS_RADIO);
+
+	if(LCD1602A_init(&hi2c1))
+	{
+		BENCH_lcdWait();
+		BENCH_run("lcd_char", BENCH_lcdChar, BENCH_ITERATIONS_LCD);
+		BENCH_run("lcd_line", BENCH_lcdLine, BENCH_ITERATIONS_LCD);
+		BENCH_run("lcd_frame", BENCH_lcdFrame, BENCH_ITERATIONS_LCD);
+	}
+	else
+	{
+		BENCH_skip("lcd_char", "lcd_missing");
+		BENCH_skip("lcd_line", "lcd_missing");
+		BENCH_skip("lcd_frame", "lcd_missing");
+	}
+
+	BENCH_run("joystick_to_percent", BENCH_joystick, BENCH_ITERATIONS);
+	BENCH_run("telemetry_control", BENCH_telemetryControl, BENCH_ITERATIONS_TELEMETRY);
+
+	BENCH_end();
+
+	while(1);
+}
+
+#endif
@@ -0,0 +1,359 @@
+/*
+Library for:				Runtime clock profiles with peripheral retiming
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- RM0390 STM32F446xx Reference Manual, 5.1.4 Voltage regulator (over-drive),
+							  3.4.1 Relation between CPU clock frequency and Flash memory read time
+							- STM32F4 HAL RCC and PWREx drivers
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_CLOCK.h"
+#include "KK_TELEMETRY.h"
+#include "KK_TRACE.h"
+
+#ifdef USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+/* Private types */
+
+typedef struct
+{
+	uint32_t voltageScale;
+	uint8_t pll;					// PLL as SYSCLK, HSI otherwise
+	uint8_t overDrive;
+	uint32_t pllm;
+	uint32_t plln;
+	uint32_t pllp;
+	uint32_t apb1Divider;
+	uint32_t apb2Divider;
+	uint32_t flashLatency;			// 3.3 V supply
+} CLOCK_Profile;
+
+/* Private handles and variables */
+
+// HSI 16 MHz in every profile - VCO input 1 MHz (PLLM 16, CubeMX setting) for DEFAULT, 2 MHz (PLLM 8,
+// lower jitter) for PERFORMANCE
+static const CLOCK_Profile clock_profiles[CLOCK_PROFILE_COUNT] =
+{
+	[CLOCK_PROFILE_LOW_POWER]	= { PWR_REGULATOR_VOLTAGE_SCALE3, 0, 0, 0, 0, 0, RCC_HCLK_DIV1, RCC_HCLK_DIV1, FLASH_LATENCY_0 },
+	[CLOCK_PROFILE_DEFAULT]		= { PWR_REGULATOR_VOLTAGE_SCALE3, 1, 0, 16, 336, RCC_PLLP_DIV4, RCC_HCLK_DIV2, RCC_HCLK_DIV1, FLASH_LATENCY_2 },
+	[CLOCK_PROFILE_PERFORMANCE]	= { PWR_REGULATOR_VOLTAGE_SCALE1, 1, 1, 8, 180, RCC_PLLP_DIV2, RCC_HCLK_DIV4, RCC_HCLK_DIV2, FLASH_LATENCY_5 },
+};
+
+static uint8_t clock_profile = CLOCK_PROFILE_DEFAULT;
+
+// Rates captured at registration
+static SPI_HandleTypeDef *clock_spi[CLOCK_MAX_PERIPHERALS];
+static uint32_t clock_spiHz[CLOCK_MAX_PERIPHERALS];
+static uint8_t clock_spiCount = 0;
+
+static UART_HandleTypeDef *clock_uart[CLOCK_MAX_PERIPHERALS];
+static uint8_t clock_uartCount = 0;
+
+#ifdef HAL_I2C_MODULE_ENABLED
+static I2C_HandleTypeDef *clock_i2c[CLOCK_MAX_PERIPHERALS];
+static uint8_t clock_i2cCount = 0;
+#endif
+
+#ifdef HAL_TIM_MODULE_ENABLED
+static TIM_HandleTypeDef *clock_timer[CLOCK_MAX_PERIPHERALS];
+static uint32_t clock_timerHz[CLOCK_MAX_PERIPHERALS];
+static uint8_t clock_timerCount = 0;
+#endif
+
+// Drivers that start transfers from interrupts (LCD queue on SysTick and I2C DMA)
+static CLOCK_HoldFunction clock_hold[CLOCK_MAX_PERIPHERALS];
+static uint8_t clock_holdCount = 0;
+
+/* Static function prototypes */
+
+static uint32_t CLOCK_busHz(const void *instance);
+static uint8_t CLOCK_busy(void);
+static uint8_t CLOCK_idle(void);
+static void CLOCK_holdAll(uint8_t hold);
+static uint8_t CLOCK_switch(const CLOCK_Profile *profile);
+static void CLOCK_retime(void);
+
+/* Functions */
+
+// Clock of the APB bus the peripheral sits on
+static uint32_t CLOCK_busHz(const void *instance)
+{
+	return ((uintptr_t)instance >= APB2PERIPH_BASE) ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+}
+
+// Clock Initialization function - SystemClock_Config has set up the DEFAULT profile
+void CLOCK_init(void)
+{
+	clock_profile = CLOCK_PROFILE_DEFAULT;
+	clock_spiCount = 0;
+	clock_uartCount = 0;
+#ifdef HAL_I2C_MODULE_ENABLED
+	clock_i2cCount = 0;
+#endif
+#ifdef HAL_TIM_MODULE_ENABLED
+	clock_timerCount = 0;
+#endif
+	clock_holdCount = 0;
+}
+
+uint8_t CLOCK_addSpi(SPI_HandleTypeDef *hspi)
+{
+	if(clock_spiCount >= CLOCK_MAX_PERIPHERALS)
+		return CLOCK_FALSE;
+
+	// BR field n divides by 2^(n+1)
+	uint32_t br = (hspi->Instance->CR1 & SPI_CR1_BR) >> SPI_CR1_BR_Pos;
+	clock_spi[clock_spiCount] = hspi;
+	clock_spiHz[clock_spiCount] = CLOCK_busHz(hspi->Instance) >> (br + 1);
+	clock_spiCount++;
+	return CLOCK_TRUE;
+}
+
+uint8_t CLOCK_addUart(UART_HandleTypeDef *huart)
+{
+	if(clock_uartCount >= CLOCK_MAX_PERIPHERALS)
+		return CLOCK_FALSE;
+
+	clock_uart[clock_uartCount++] = huart;
+	return CLOCK_TRUE;
+}
+
+#ifdef HAL_I2C_MODULE_ENABLED
+uint8_t CLOCK_addI2c(I2C_HandleTypeDef *hi2c)
+{
+	if(clock_i2cCount >= CLOCK_MAX_PERIPHERALS)
+		return CLOCK_FALSE;
+
+	clock_i2c[clock_i2cCount++] = hi2c;
+	return CLOCK_TRUE;
+}
+#endif
+
+#ifdef HAL_TIM_MODULE_ENABLED
+// Timer kernel clock is twice the APB clock whenever the APB divider is not 1
+uint8_t CLOCK_addTimer(TIM_HandleTypeDef *htim)
+{
+	if(clock_timerCount >= CLOCK_MAX_PERIPHERALS)
+		return CLOCK_FALSE;
+
+	uint32_t apb = ((uintptr_t)htim->Instance >= APB2PERIPH_BASE) ? (RCC->CFGR & RCC_CFGR_PPRE2) : (RCC->CFGR & RCC_CFGR_PPRE1);
+	uint32_t kernel = CLOCK_busHz(htim->Instance) * (apb ? 2 : 1);
+
+	clock_timer[clock_timerCount] = htim;
+	clock_timerHz[clock_timerCount] = kernel / (htim->Instance->PSC + 1);
+	clock_timerCount++;
+	return CLOCK_TRUE;
+}
+#endif
+
+uint8_t CLOCK_addHold(CLOCK_HoldFunction hold)
+{
+	if(clock_holdCount >= CLOCK_MAX_PERIPHERALS)
+		return CLOCK_FALSE;
+
+	clock_hold[clock_holdCount++] = hold;
+	return CLOCK_TRUE;
+}
+
+// Transfer running on a registered UART, I2C or SPI
+static uint8_t CLOCK_busy(void)
+{
+	uint8_t busy = 0;
+
+	for(uint8_t i = 0; i < clock_uartCount; i++)
+		busy |= (clock_uart[i]->gState != HAL_UART_STATE_READY) || !(clock_uart[i]->Instance->SR & USART_SR_TC);
+#ifdef HAL_I2C_MODULE_ENABLED
+	for(uint8_t i = 0; i < clock_i2cCount; i++)
+		busy |= (clock_i2c[i]->State != HAL_I2C_STATE_READY);
+#endif
+	for(uint8_t i = 0; i < clock_spiCount; i++)
+		busy |= (clock_spi[i]->Instance->SR & SPI_SR_BSY) != 0;
+
+	return busy;
+}
+
+// Waits for running UART and I2C transfers, SPI users (NRF24) are blocking and idle here
+static uint8_t CLOCK_idle(void)
+{
+	uint32_t start = HAL_GetTick();
+
+	do
+	{
+		if(!CLOCK_busy())
+			return CLOCK_TRUE;
+	} while((HAL_GetTick() - start) < CLOCK_IDLE_TIMEOUT);
+
+	return CLOCK_FALSE;
+}
+
+static void CLOCK_holdAll(uint8_t hold)
+{
+	for(uint8_t i = 0; i < clock_holdCount; i++)
+		clock_hold[i](hold);
+}
+
+// HSI first, then regulator and PLL can be changed, PLL is switched in last
+static uint8_t CLOCK_switch(const CLOCK_Profile *profile)
+{
+	RCC_OscInitTypeDef osc = {0};
+	RCC_ClkInitTypeDef clk = {0};
+
+	clk.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+	clk.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+	clk.AHBCLKDivider = RCC_SYSCLK_DIV1;
+	clk.APB1CLKDivider = RCC_HCLK_DIV1;
+	clk.APB2CLKDivider = RCC_HCLK_DIV1;
+	if(HAL_RCC_ClockConfig(&clk, FLASH_LATENCY_0) != HAL_OK)
+		return CLOCK_FALSE;
+
+	if((PWR->CSR & PWR_CSR_ODRDY) && HAL_PWREx_DisableOverDrive() != HAL_OK)
+		return CLOCK_FALSE;
+
+	// Regulator scale is taken over when PLL turns on
+	osc.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+	osc.PLL.PLLState = RCC_PLL_OFF;
+	if(HAL_RCC_OscConfig(&osc) != HAL_OK)
+		return CLOCK_FALSE;
+	__HAL_PWR_VOLTAGESCALING_CONFIG(profile->voltageScale);
+
+	if(profile->pll)
+	{
+		osc.PLL.PLLState = RCC_PLL_ON;
+		osc.PLL.PLLSource = RCC_PLLSOURCE_HSI;
+		osc.PLL.PLLM = profile->pllm;
+		osc.PLL.PLLN = profile->plln;
+		osc.PLL.PLLP = profile->pllp;
+		osc.PLL.PLLQ = 2;
+		osc.PLL.PLLR = 2;
+		if(HAL_RCC_OscConfig(&osc) != HAL_OK)
+			return CLOCK_FALSE;
+
+		if(profile->overDrive && HAL_PWREx_EnableOverDrive() != HAL_OK)
+			return CLOCK_FALSE;
+
+		clk.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+	}
+
+	// Updates SystemCoreClock and SysTick
+	clk.APB1CLKDivider = profile->apb1Divider;
+	clk.APB2CLKDivider = profile->apb2Divider;
+	if(HAL_RCC_ClockConfig(&clk, profile->flashLatency) != HAL_OK)
+		return CLOCK_FALSE;
+
+	return CLOCK_TRUE;
+}
+
+// Dividers of registered peripherals for the bus clocks just set
+static void CLOCK_retime(void)
+{
+	for(uint8_t i = 0; i < clock_spiCount; i++)
+	{
+		SPI_HandleTypeDef *hspi = clock_spi[i];
+		uint32_t bus = CLOCK_busHz(hspi->Instance);
+		uint32_t target = clock_spiHz[i];
+		uint32_t br = 0;
+
+		// Slower divider only while it lands closer to the captured rate
+		while(br < 7)
+		{
+			uint32_t rate = bus >> (br + 1);
+			uint32_t slower = bus >> (br + 2);
+
+			if(rate <= target || (slower < target && (rate - target) <= (target - slower)))
+				break;
+			br++;
+		}
+
+		// BR may only change with SPI disabled
+		uint32_t enabled = hspi->Instance->CR1 & SPI_CR1_SPE;
+		__HAL_SPI_DISABLE(hspi);
+		MODIFY_REG(hspi->Instance->CR1, SPI_CR1_BR, br << SPI_CR1_BR_Pos);
+		hspi->Init.BaudRatePrescaler = br << SPI_CR1_BR_Pos;
+		hspi->Instance->CR1 |= enabled;
+	}
+
+	for(uint8_t i = 0; i < clock_uartCount; i++)
+	{
+		UART_HandleTypeDef *huart = clock_uart[i];
+		uint32_t bus = CLOCK_busHz(huart->Instance);
+
+		if(huart->Init.OverSampling == UART_OVERSAMPLING_8)
+			huart->Instance->BRR = UART_BRR_SAMPLING8(bus, huart->Init.BaudRate);
+		else
+			huart->Instance->BRR = UART_BRR_SAMPLING16(bus, huart->Init.BaudRate);
+	}
+
+#ifdef HAL_I2C_MODULE_ENABLED
+	for(uint8_t i = 0; i < clock_i2cCount; i++)
+		HAL_I2C_Init(clock_i2c[i]);
+#endif
+
+#ifdef HAL_TIM_MODULE_ENABLED
+	for(uint8_t i = 0; i < clock_timerCount; i++)
+	{
+		TIM_HandleTypeDef *htim = clock_timer[i];
+		uint32_t apb = ((uintptr_t)htim->Instance >= APB2PERIPH_BASE) ? (RCC->CFGR & RCC_CFGR_PPRE2) : (RCC->CFGR & RCC_CFGR_PPRE1);
+		uint32_t kernel = CLOCK_busHz(htim->Instance) * (apb ? 2 : 1);
+		uint32_t psc = (kernel + clock_timerHz[i] / 2) / clock_timerHz[i] - 1;
+
+		__HAL_TIM_SET_PRESCALER(htim, psc);
+		htim->Init.Prescaler = psc;
+	}
+#endif
+
+	TRACE_retime();
+}
+
+// Returns CLOCK_FALSE when peripherals stayed busy (nothing changed) or HAL failed midway -
+// the board then runs LOW_POWER, which is where every switch passes through
+uint8_t CLOCK_setProfile(uint8_t profile)
+{
+	if(profile >= CLOCK_PROFILE_COUNT)
+		return CLOCK_FALSE;
+	if(profile == clock_profile)
+		return CLOCK_TRUE;
+
+	// Interrupt-started transfers stop first, the wait covers the ones already running
+	CLOCK_holdAll(CLOCK_TRUE);
+	if(!CLOCK_idle())
+	{
+		CLOCK_holdAll(CLOCK_FALSE);
+		return CLOCK_FALSE;
+	}
+
+	// From the last idle check to the new dividers no task may start a transfer - interrupts
+	// stay enabled, HAL RCC timeouts count SysTick
+#ifdef USE_FREERTOS
+	vTaskSuspendAll();
+#endif
+	uint8_t status = CLOCK_FALSE;
+	if(!CLOCK_busy())
+	{
+		status = CLOCK_switch(&clock_profiles[profile]);
+		if(__HAL_RCC_GET_SYSCLK_SOURCE() == RCC_SYSCLKSOURCE_STATUS_HSI)
+			clock_profile = CLOCK_PROFILE_LOW_POWER;
+		if(status)
+			clock_profile = profile;
+
+		CLOCK_retime();
+	}
+#ifdef USE_FREERTOS
+	xTaskResumeAll();
+#endif
+	CLOCK_holdAll(CLOCK_FALSE);
+
+	TRACE_event(TRACE_EVENT_CLOCK, SystemCoreClock / 1000000);
+	TELEMETRY_sendEvent(TELEMETRY_EVENT_CLOCK, SystemCoreClock / 1000000);
+	return status;
+}
+
+uint8_t CLOCK_getProfile(void)
+{
+	return clock_profile;
+}
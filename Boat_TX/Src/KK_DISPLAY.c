@@ -0,0 +1,137 @@
+/*
+Library for:				Boat_TX display pages (LCD1602A)
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- KK_LCD1602A library
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#include "KK_DISPLAY.h"
+
+
+/* Library variables */
+static volatile uint8_t DISPLAY_page = DISPLAY_PAGE_STICKS;
+static uint8_t DISPLAY_shownPage = DISPLAY_PAGE_COUNT;
+static uint32_t DISPLAY_refreshTick = 0;
+
+// Packet rate is counted between refreshes
+static uint32_t DISPLAY_rateAcked = 0;
+static uint32_t DISPLAY_rate = 0;
+
+
+/* Private functions */
+
+// Link quality in percent
+static uint32_t DISPLAY_linkQuality(const DISPLAY_Telemetry *telemetry)
+{
+	return (__builtin_popcount(telemetry->linkHistory) * 100) / 16;
+}
+
+// S 57 [speed bar  ]
+// D 50 [dir ] L[lq]
+static void DISPLAY_drawSticks(const DISPLAY_Telemetry *telemetry)
+{
+	LCD1602A_fbPutString(0, 0, "S");
+	LCD1602A_fbPutUint(0, 1, telemetry->speed, 3);
+	LCD1602A_fbPutBar(0, 5, 11, telemetry->speed, 100);
+	LCD1602A_fbPutString(1, 0, "D");
+	LCD1602A_fbPutUint(1, 1, telemetry->direction, 3);
+	LCD1602A_fbPutBar(1, 5, 6, telemetry->direction, 100);
+	LCD1602A_fbPutString(1, 12, "L");
+	LCD1602A_fbPutBar(1, 13, 3, __builtin_popcount(telemetry->linkHistory), 16);
+}
+
+// Sent      123456
+// Lost         123
+static void DISPLAY_drawLink(const DISPLAY_Telemetry *telemetry)
+{
+	LCD1602A_fbPutString(0, 0, "Sent");
+	LCD1602A_fbPutUint(0, 4, telemetry->packetsSent, 12);
+	LCD1602A_fbPutString(1, 0, "Lost");
+	LCD1602A_fbPutUint(1, 4, telemetry->packetsSent - telemetry->packetsAcked, 12);
+}
+
+// Rate    9 pkt/s
+// LQ  94% [bar   ]
+static void DISPLAY_drawRate(const DISPLAY_Telemetry *telemetry)
+{
+	LCD1602A_fbPutString(0, 0, "Rate");
+	LCD1602A_fbPutUint(0, 4, DISPLAY_rate, 5);
+	LCD1602A_fbPutString(0, 10, "pkt/s");
+	LCD1602A_fbPutString(1, 0, "LQ");
+	LCD1602A_fbPutUint(1, 2, DISPLAY_linkQuality(telemetry), 4);
+	LCD1602A_fbPutString(1, 6, "%");
+	LCD1602A_fbPutBar(1, 8, 8, DISPLAY_linkQuality(telemetry), 100);
+}
+
+// Loop      2 ms
+// Max      13 ms
+static void DISPLAY_drawLoop(const DISPLAY_Telemetry *telemetry)
+{
+	LCD1602A_fbPutString(0, 0, "Loop");
+	LCD1602A_fbPutUint(0, 4, telemetry->loopTime, 7);
+	LCD1602A_fbPutString(0, 12, "ms");
+	LCD1602A_fbPutString(1, 0, "Max");
+	LCD1602A_fbPutUint(1, 4, telemetry->loopTimeMax, 7);
+	LCD1602A_fbPutString(1, 12, "ms");
+}
+
+
+/* Functions */
+
+// B1 (PC13) interrupt - button cycles pages
+void DISPLAY_init(void)
+{
+	DISPLAY_refreshTick = HAL_GetTick();
+
+	HAL_NVIC_SetPriority(EXTI15_10_IRQn, 6, 0);
+	HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+}
+
+// Call from buttonTask - one call per debounced press
+void DISPLAY_nextPage(void)
+{
+	DISPLAY_page = (DISPLAY_page + 1) % DISPLAY_PAGE_COUNT;
+}
+
+// Call from main loop after control work - renders at most every DISPLAY_REFRESH_PERIOD or on page change
+void DISPLAY_process(const DISPLAY_Telemetry *telemetry)
+{
+	uint32_t now = HAL_GetTick();
+	uint32_t elapsed = now - DISPLAY_refreshTick;
+	uint8_t page = DISPLAY_page;
+
+	LCD1602A_process();
+
+	if(elapsed < DISPLAY_REFRESH_PERIOD && page == DISPLAY_shownPage)
+		return;
+
+	if(elapsed >= DISPLAY_REFRESH_PERIOD)
+	{
+		DISPLAY_rate = ((telemetry->packetsAcked - DISPLAY_rateAcked) * 1000) / elapsed;
+		DISPLAY_rateAcked = telemetry->packetsAcked;
+		DISPLAY_refreshTick = now;
+	}
+
+	LCD1602A_fbClear();
+
+	switch(page)
+	{
+	case DISPLAY_PAGE_LINK:
+		DISPLAY_drawLink(telemetry);
+		break;
+	case DISPLAY_PAGE_RATE:
+		DISPLAY_drawRate(telemetry);
+		break;
+	case DISPLAY_PAGE_LOOP:
+		DISPLAY_drawLoop(telemetry);
+		break;
+	default:
+		DISPLAY_drawSticks(telemetry);
+		break;
+	}
+
+	// Only changed cells are queued, transfer runs over DMA in background
+	LCD1602A_flush();
+	DISPLAY_shownPage = page;
+}
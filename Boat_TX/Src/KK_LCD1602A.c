@@ -5,44 +5,412 @@ Based on:					- HD44780U Datasheet
 							- PCF8574 Datasheet
 							- Mohamed Yaqoob's STM32 Tutorials
 First update:				26/12/2020
-Last update:				27/12/2020
+Last update:				18/10/2026
 */
 
 #include "KK_LCD1602A.h"
+#include "KK_PIN.h"
+#include "KK_TRACE.h"
+
+PIN_ASSERT(LCD_SCL_GPIO_Port, LCD_SCL_Pin);
+PIN_ASSERT(LCD_SDA_GPIO_Port, LCD_SDA_Pin);
+PIN_ASSERT_DISTINCT(LCD_SCL_GPIO_Port, LCD_SCL_Pin, LCD_SDA_GPIO_Port, LCD_SDA_Pin);
 
 
 /* Library variables */
 static I2C_HandleTypeDef* LCD1602A_hi2c;
 static uint8_t LCD_I2C_SLAVE_ADDRESS = 0;
 
+// Framebuffer - what application wants to show and what display actually shows
+static uint8_t LCD1602A_frame[LCD_ROWS][LCD_COLS];
+static uint8_t LCD1602A_shown[LCD_ROWS][LCD_COLS];
+
+// Tracked DDRAM cursor position (col == LCD_COLS means cursor left the visible area)
+static uint8_t LCD_cursorRow = 0;
+static uint8_t LCD_cursorCol = 0;
+
+// Transaction queue - written by application, drained from I2C DMA and SysTick interrupts
+typedef struct
+{
+	uint8_t data[LCD_SEGMENT_SIZE];
+	uint8_t len;
+	uint8_t delay;
+} LCD1602A_Segment;
+
+static LCD1602A_Segment LCD_queue[LCD_QUEUE_SIZE];
+static volatile uint8_t LCD_queueHead = 0;
+static volatile uint8_t LCD_queueTail = 0;
+static volatile uint8_t LCD_inFlight = FALSE;
+static volatile uint8_t LCD_waitTicks = 0;
+static volatile uint8_t LCD_flightTicks = 0;
+static uint8_t LCD_async = FALSE;
+static uint8_t LCD_hold = FALSE;
+static volatile uint8_t LCD_paused = FALSE;		// no new transfer from any context (clock switch)
+
+// Device presence - changed by transfer results, background probing runs from LCD1602A_process()
+static volatile uint8_t LCD_state = LCD_STATE_ABSENT;
+static uint32_t LCD_probeTick = 0;
+static uint8_t LCD_probeIndex = 0;
+#if LCD_I2C_ADDRESS
+static const uint8_t LCD_I2C_SLAVE_ADDRESSES[] = { LCD_I2C_ADDRESS };
+#else
+static const uint8_t LCD_I2C_SLAVE_ADDRESSES[] = { LCD_I2C_SLAVE_ADDRESS_0, LCD_I2C_SLAVE_ADDRESS_1 };
+#endif
+#define LCD_ADDRESS_COUNT			(sizeof(LCD_I2C_SLAVE_ADDRESSES) / sizeof(LCD_I2C_SLAVE_ADDRESSES[0]))
+
+// Horizontal bar glyphs - CGRAM slots 1-4 hold 1-4 lit pixel columns (slot 0 avoided, it is string terminator)
+static const uint8_t LCD1602A_barGlyphs[4][8] =
+{
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 },
+	{ 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18 },
+	{ 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C },
+	{ 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E },
+};
+
+// Busy flag polling - enabled once LCD is in 4-bit mode, cleared for good when read back fails
+static uint8_t LCD_busyFlag = FALSE;
+
 
 /* Private functions */
-static void LCD1602A_sendCommand(uint8_t command)
+
+// Start next queued transaction if bus is free and no command delay is pending (interrupt context safe)
+static void LCD1602A_kick(void)
+{
+	if(LCD_paused || LCD_inFlight || LCD_waitTicks || LCD_queueHead == LCD_queueTail || LCD_state == LCD_STATE_FAULT)
+		return;
+
+	// HAL spins up to 25 ms on a stuck BUSY flag - leave it for bus recovery instead
+	if(__HAL_I2C_GET_FLAG(LCD1602A_hi2c, I2C_FLAG_BUSY))
+	{
+		LCD_state = LCD_STATE_FAULT;
+		return;
+	}
+
+	LCD1602A_Segment *segment = &LCD_queue[LCD_queueTail];
+	LCD_inFlight = TRUE;
+	LCD_flightTicks = 0;
+	TRACE_event(TRACE_EVENT_I2C_BEGIN, segment->len);
+	if(HAL_I2C_Master_Transmit_DMA(LCD1602A_hi2c, LCD_I2C_SLAVE_ADDRESS, segment->data, segment->len) != HAL_OK)
+	{
+		// Drop segment, otherwise a dead bus would block the queue forever
+		LCD_queueTail = (LCD_queueTail + 1) & (LCD_QUEUE_SIZE - 1);
+		LCD_inFlight = FALSE;
+		TRACE_event(TRACE_EVENT_I2C_END, 0);
+	}
+}
+
+// Forget everything queued (device gone)
+static void LCD1602A_dropQueue(void)
+{
+	LCD_queueTail = LCD_queueHead;
+	LCD_waitTicks = 0;
+}
+
+// Free segments in queue
+static uint8_t LCD1602A_queueFree(void)
+{
+	return (LCD_QUEUE_SIZE - 1) - ((LCD_queueHead - LCD_queueTail) & (LCD_QUEUE_SIZE - 1));
+}
+
+// Start queue from application context
+static void LCD1602A_release(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	LCD1602A_kick();
+	__set_PRIMASK(primask);
+}
+
+#if LCD_USE_BUSY_FLAG
+// Read busy flag (RW = 1, RS = 0 - 24 and 33 page in the datasheet)
+static uint8_t LCD1602A_readBusy(uint8_t *busy)
+{
+	// Data lines written high so PCF8574 quasi-bidirectional port can be pulled low by LCD
+	uint8_t enHigh[2] =
+	{
+		0xF0 | LCD_RW | LCD_BK_LIGHT,
+		0xF0 | LCD_RW | LCD_BK_LIGHT | LCD_EN,
+	};
+	// Second nibble (address counter low bits) has to be clocked out too
+	uint8_t enLow[3] =
+	{
+		0xF0 | LCD_RW | LCD_BK_LIGHT,
+		0xF0 | LCD_RW | LCD_BK_LIGHT | LCD_EN,
+		0xF0 | LCD_RW | LCD_BK_LIGHT,
+	};
+	uint8_t port = 0;
+
+	if(HAL_I2C_Master_Transmit(LCD1602A_hi2c, LCD_I2C_SLAVE_ADDRESS, enHigh, 2, LCD_I2C_TIMEOUT) != HAL_OK)
+		return FALSE;
+	if(HAL_I2C_Master_Receive(LCD1602A_hi2c, LCD_I2C_SLAVE_ADDRESS, &port, 1, LCD_I2C_TIMEOUT) != HAL_OK)
+		return FALSE;
+	if(HAL_I2C_Master_Transmit(LCD1602A_hi2c, LCD_I2C_SLAVE_ADDRESS, enLow, 3, LCD_I2C_TIMEOUT) != HAL_OK)
+		return FALSE;
+
+	// DB7 is wired to P7
+	*busy = (port & 0x80) ? TRUE : FALSE;
+	return TRUE;
+}
+#endif
+
+// Wait until LCD is ready - busy flag when available, fixed worst case delay as fallback
+static void LCD1602A_waitReady(uint8_t delay)
+{
+#if LCD_USE_BUSY_FLAG
+	if(LCD_busyFlag)
+	{
+		uint32_t start = HAL_GetTick();
+		uint8_t busy = TRUE;
+
+		// Fixed delay is the upper bound of polling, tick granularity needs one more period
+		while(LCD1602A_readBusy(&busy) && busy && (HAL_GetTick() - start) <= delay);
+
+		if(!busy)
+			return;
+
+		// Bus error or LCD never reported ready - wait out what is left of the fixed delay
+		LCD_busyFlag = FALSE;
+		uint32_t elapsed = HAL_GetTick() - start;
+		if(elapsed < delay)
+			HAL_Delay(delay - elapsed);
+		return;
+	}
+#endif
+
+	HAL_Delay(delay);
+}
+
+// Queue bytes for DMA transfer, delay (ms) is kept after the transfer
+static uint8_t LCD1602A_enqueue(const uint8_t *data, uint8_t len, uint8_t delay)
+{
+	uint8_t result = FALSE;
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	// Append to newest segment while it still waits for the bus - one start, address and stop for a whole run
+	uint8_t last = (LCD_queueHead - 1) & (LCD_QUEUE_SIZE - 1);
+	LCD1602A_Segment *segment = &LCD_queue[last];
+
+	if(LCD_queueHead != LCD_queueTail && !(last == LCD_queueTail && LCD_inFlight)
+			&& segment->delay == 0 && segment->len + len <= LCD_SEGMENT_SIZE)
+	{
+		memcpy(&segment->data[segment->len], data, len);
+		segment->len += len;
+		segment->delay = delay;
+		result = TRUE;
+	}
+	else if(LCD1602A_queueFree() != 0)
+	{
+		segment = &LCD_queue[LCD_queueHead];
+		memcpy(segment->data, data, len);
+		segment->len = len;
+		segment->delay = delay;
+		LCD_queueHead = (LCD_queueHead + 1) & (LCD_QUEUE_SIZE - 1);
+		result = TRUE;
+	}
+
+	if(!LCD_hold)
+		LCD1602A_kick();
+
+	__set_PRIMASK(primask);
+	return result;
+}
+
+// Send bytes to PCF8574 - queued in async mode, blocking with fixed delay before (init sequence)
+static uint8_t LCD1602A_transmit(const uint8_t *data, uint8_t len, uint8_t delay)
 {
-  const uint8_t command_0_3 = (0xF0 & (command << 4));
-  const uint8_t command_4_7 = (0xF0 & command);
-  uint8_t i2cData[4] =
-  {
-      command_4_7 | LCD_EN | LCD_BK_LIGHT,
-      command_4_7 | LCD_BK_LIGHT,
-      command_0_3 | LCD_EN | LCD_BK_LIGHT,
-      command_0_3 | LCD_BK_LIGHT,
-  };
-  HAL_I2C_Master_Transmit(LCD1602A_hi2c, LCD_I2C_SLAVE_ADDRESS, i2cData, 4, 200);
+	if(LCD_state != LCD_STATE_PRESENT)
+		return FALSE;
+
+	if(LCD_async)
+		return LCD1602A_enqueue(data, len, delay);
+
+	if(HAL_I2C_Master_Transmit(LCD1602A_hi2c, LCD_I2C_SLAVE_ADDRESS, (uint8_t *)data, len, LCD_I2C_TIMEOUT) != HAL_OK)
+	{
+		LCD_state = LCD_STATE_ABSENT;
+		return FALSE;
+	}
+
+	if(delay)
+		LCD1602A_waitReady(delay);
+	return TRUE;
+}
+
+// Build PCF8574 byte stream for one HD44780 write - two nibbles, each latched on EN falling edge
+static uint8_t LCD1602A_write(uint8_t value, uint8_t rs, uint8_t delay)
+{
+	const uint8_t value_0_3 = (0xF0 & (value << 4)) | LCD_BK_LIGHT | rs;
+	const uint8_t value_4_7 = (0xF0 & value) | LCD_BK_LIGHT | rs;
+	uint8_t i2cData[LCD_BYTES_PER_WRITE];
+
+	i2cData[0] = value_4_7 | LCD_EN;
+	i2cData[1] = value_4_7;
+	i2cData[2] = value_0_3 | LCD_EN;
+	i2cData[3] = value_0_3;
+
+	// Padding keeps EN low until execution time of this write has passed
+	for(uint8_t i = 4; i < LCD_BYTES_PER_WRITE; i++)
+		i2cData[i] = value_0_3;
+
+	return LCD1602A_transmit(i2cData, LCD_BYTES_PER_WRITE, delay);
+}
+
+static uint8_t LCD1602A_sendCommand(uint8_t command, uint8_t delay)
+{
+	return LCD1602A_write(command, 0, delay);
+}
+
+static uint8_t LCD1602A_sendData(uint8_t data)
+{
+	return LCD1602A_write(data, LCD_RS, 0);
+}
+
+// Move tracked cursor
+static uint8_t LCD1602A_moveCursor(uint8_t row, uint8_t col)
+{
+    uint8_t maskData;
+    maskData = (col) & 0x0F;
+
+    if(row == 0)
+    	maskData |= 0x80;
+    else
+    	maskData |= 0xC0;
+
+    if(!LCD1602A_sendCommand(maskData, 0))
+    	return FALSE;
+
+    LCD_cursorRow = row ? 1 : 0;
+    LCD_cursorCol = col & 0x0F;
+    return TRUE;
+}
+
+// Write character at tracked cursor position and keep both buffers in sync
+static uint8_t LCD1602A_putChar(uint8_t c)
+{
+	if(!LCD1602A_sendData(c))
+		return FALSE;
+
+	if(LCD_cursorCol < LCD_COLS)
+	{
+		LCD1602A_frame[LCD_cursorRow][LCD_cursorCol] = c;
+		LCD1602A_shown[LCD_cursorRow][LCD_cursorCol] = c;
+	}
+
+	// DDRAM address auto-increments after every write (entry mode I/D = 1)
+	LCD_cursorCol++;
+	return TRUE;
+}
+
+// Switch to DMA queue - probing continues in background when LCD was not found
+static void LCD1602A_startAsync(void)
+{
+    LCD_queueHead = 0;
+    LCD_queueTail = 0;
+    LCD_inFlight = FALSE;
+    LCD_waitTicks = 0;
+    LCD_probeTick = HAL_GetTick();
+    LCD_async = TRUE;
+}
+
+// Load bar glyphs into CGRAM
+static void LCD1602A_loadBarGlyphs(void)
+{
+    for(uint8_t i = 0; i < 4; i++)
+    	LCD1602A_loadGlyph(LCD_GLYPH_BAR_1 + i, LCD1602A_barGlyphs[i]);
+}
+
+// Init sequence for a hot-plugged LCD - queued with fixed delays, nothing blocks
+static void LCD1602A_queueInit(void)
+{
+	uint8_t backlight = LCD_BK_LIGHT;
+
+	LCD_hold = TRUE;
+
+	// Power on wait (40 ms after Vcc - 46 page in the datasheet) kept after backlight byte
+	LCD1602A_enqueue(&backlight, 1, 50);
+
+	// Attentions Sequence - writes without delay are covered by byte stream timing
+	LCD1602A_sendCommand(0x30, 5);
+	LCD1602A_sendCommand(0x30, 1);
+	LCD1602A_sendCommand(0x30, 0);
+	LCD1602A_sendCommand(0x20, 0);
+	LCD1602A_sendCommand(LCD_FUNCTIONSET | LCD_FUNCTION_N, 0);
+	LCD1602A_sendCommand(LCD_DISPLAYCONTROL, 0);
+	LCD1602A_clear();
+	LCD1602A_sendCommand(0x04 | LCD_ENTRY_ID, 0);
+	LCD1602A_sendCommand(LCD_DISPLAYCONTROL | LCD_DISPLAY_D, 0);
+	LCD1602A_loadBarGlyphs();
+
+	LCD_hold = FALSE;
+	LCD1602A_release();
+}
+
+// Release bus stuck by a slave holding SDA low - 9 SCL pulses and STOP (I2C-bus specification 3.1.16)
+static void LCD1602A_recoverBus(void)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	volatile uint32_t wait;
+	const uint32_t halfPeriod = SystemCoreClock / 400000;
+
+	HAL_I2C_DeInit(LCD1602A_hi2c);
+
+	HAL_GPIO_WritePin(LCD_SCL_GPIO_Port, LCD_SCL_Pin, GPIO_PIN_SET);
+	HAL_GPIO_WritePin(LCD_SDA_GPIO_Port, LCD_SDA_Pin, GPIO_PIN_SET);
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+	GPIO_InitStruct.Pull = GPIO_PULLUP;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	GPIO_InitStruct.Pin = LCD_SCL_Pin;
+	HAL_GPIO_Init(LCD_SCL_GPIO_Port, &GPIO_InitStruct);
+	GPIO_InitStruct.Pin = LCD_SDA_Pin;
+	HAL_GPIO_Init(LCD_SDA_GPIO_Port, &GPIO_InitStruct);
+
+	for(uint8_t i = 0; i < 9 && HAL_GPIO_ReadPin(LCD_SDA_GPIO_Port, LCD_SDA_Pin) == GPIO_PIN_RESET; i++)
+	{
+		HAL_GPIO_WritePin(LCD_SCL_GPIO_Port, LCD_SCL_Pin, GPIO_PIN_RESET);
+		for(wait = halfPeriod; wait; wait--);
+		HAL_GPIO_WritePin(LCD_SCL_GPIO_Port, LCD_SCL_Pin, GPIO_PIN_SET);
+		for(wait = halfPeriod; wait; wait--);
+	}
+
+	// STOP condition - SDA rising while SCL high
+	HAL_GPIO_WritePin(LCD_SCL_GPIO_Port, LCD_SCL_Pin, GPIO_PIN_RESET);
+	HAL_GPIO_WritePin(LCD_SDA_GPIO_Port, LCD_SDA_Pin, GPIO_PIN_RESET);
+	for(wait = halfPeriod; wait; wait--);
+	HAL_GPIO_WritePin(LCD_SCL_GPIO_Port, LCD_SCL_Pin, GPIO_PIN_SET);
+	for(wait = halfPeriod; wait; wait--);
+	HAL_GPIO_WritePin(LCD_SDA_GPIO_Port, LCD_SDA_Pin, GPIO_PIN_SET);
+	for(wait = halfPeriod; wait; wait--);
+
+	// Peripheral reset clears BUSY flag latched during the hang, MspInit restores pins and DMA
+	__HAL_RCC_I2C1_FORCE_RESET();
+	__HAL_RCC_I2C1_RELEASE_RESET();
+	HAL_I2C_Init(LCD1602A_hi2c);
+
+	LCD1602A_dropQueue();
+	LCD_inFlight = FALSE;
 }
 
-static void LCD1602A_sendData(uint8_t data)
+// Queue all changed cells, returns FALSE when queue got full
+static uint8_t LCD1602A_flushCells(void)
 {
-  const uint8_t data_0_3 = (0xF0 & (data << 4));
-  const uint8_t data_4_7 = (0xF0 & data);
-  uint8_t i2cData[4] =
-  {
-      data_4_7 | LCD_EN | LCD_BK_LIGHT | LCD_RS,
-      data_4_7 | LCD_BK_LIGHT | LCD_RS,
-      data_0_3 | LCD_EN | LCD_BK_LIGHT | LCD_RS,
-      data_0_3 | LCD_BK_LIGHT | LCD_RS,
-  };
-  HAL_I2C_Master_Transmit(LCD1602A_hi2c, LCD_I2C_SLAVE_ADDRESS, i2cData, 4, 200);
+	for(uint8_t row = 0; row < LCD_ROWS; row++)
+	{
+		for(uint8_t col = 0; col < LCD_COLS; col++)
+		{
+			if(LCD1602A_frame[row][col] == LCD1602A_shown[row][col])
+				continue;
+
+			if(LCD_cursorRow != row || LCD_cursorCol != col)
+			{
+				if(!LCD1602A_moveCursor(row, col))
+					return FALSE;
+			}
+
+			if(!LCD1602A_putChar(LCD1602A_frame[row][col]))
+				return FALSE;
+		}
+	}
+	return TRUE;
 }
 
 
@@ -52,88 +420,344 @@ uint8_t LCD1602A_init(I2C_HandleTypeDef *pI2cHandle)
     HAL_Delay(50);
 
     LCD1602A_hi2c = pI2cHandle;
+    LCD_async = FALSE;
+    LCD_state = LCD_STATE_PRESENT;
 
-    // Look For Proper I2C Slave Address
-    if(HAL_I2C_IsDeviceReady(LCD1602A_hi2c, LCD_I2C_SLAVE_ADDRESS_0, 5, 100) != HAL_OK)
+    // Bus speed selected for LCD (timing of byte stream depends on it)
+    if(LCD1602A_hi2c->Init.ClockSpeed != LCD_I2C_CLOCK_SPEED)
     {
-    	if(HAL_I2C_IsDeviceReady(LCD1602A_hi2c, LCD_I2C_SLAVE_ADDRESS_1, 5, 100) != HAL_OK)
-        {
-    		return FALSE;
-        }
-        else
-        {
-            LCD_I2C_SLAVE_ADDRESS = LCD_I2C_SLAVE_ADDRESS_1;
-        }
+    	LCD1602A_hi2c->Init.ClockSpeed = LCD_I2C_CLOCK_SPEED;
+    	LCD1602A_hi2c->Init.DutyCycle = I2C_DUTYCYCLE_2;
+    	HAL_I2C_Init(LCD1602A_hi2c);
     }
-    else
+
+    // Look For Proper I2C Slave Address - only one candidate with LCD_I2C_ADDRESS set
+    LCD_I2C_SLAVE_ADDRESS = 0;
+    for(uint8_t i = 0; i < LCD_ADDRESS_COUNT && !LCD_I2C_SLAVE_ADDRESS; i++)
+    {
+    	if(HAL_I2C_IsDeviceReady(LCD1602A_hi2c, LCD_I2C_SLAVE_ADDRESSES[i], 3, LCD_I2C_TIMEOUT) == HAL_OK)
+    		LCD_I2C_SLAVE_ADDRESS = LCD_I2C_SLAVE_ADDRESSES[i];
+    }
+
+    if(!LCD_I2C_SLAVE_ADDRESS)
     {
-	    LCD_I2C_SLAVE_ADDRESS = LCD_I2C_SLAVE_ADDRESS_0;
+    	// Not connected - keep looking for it from LCD1602A_process()
+    	LCD_state = LCD_STATE_ABSENT;
+    	LCD1602A_startAsync();
+    	return FALSE;
     }
 
-    // Initialise LCD For 4-bit Operation
+    // Initialise LCD For 4-bit Operation - power on wait already passed during address lookup
+#if !LCD_USE_BUSY_FLAG
     HAL_Delay(50);
+#endif
+
+    // Attentions Sequence - busy flag cannot be checked yet (46 page in the datasheet)
+    LCD_busyFlag = FALSE;
+    LCD1602A_sendCommand(0x30, 5);
+    LCD1602A_sendCommand(0x30, 1);
+#if LCD_USE_BUSY_FLAG
+    LCD1602A_sendCommand(0x30, 1);
+    LCD1602A_sendCommand(0x20, 1);
+    LCD1602A_sendCommand(LCD_FUNCTIONSET | LCD_FUNCTION_N, 1);
+
+    // Detect RW - LCD is idle after the fixed delay, so a valid readback has BF low. With RW tied to
+    // GND the read clocks 0xFF in as set DDRAM address instead, clear below resets it
+    uint8_t busy = TRUE;
+    LCD_busyFlag = LCD1602A_readBusy(&busy) && !busy;
+#else
+    LCD1602A_sendCommand(0x30, 8);
+    LCD1602A_sendCommand(0x20, 8);
+    LCD1602A_sendCommand(LCD_FUNCTIONSET | LCD_FUNCTION_N, 1);
+#endif
+
+    LCD1602A_sendCommand(LCD_DISPLAYCONTROL, 1);
+    LCD1602A_sendCommand(LCD_CLEARDISPLAY, 3);
+    LCD1602A_sendCommand(0x04 | LCD_ENTRY_ID, 1);
+    LCD1602A_sendCommand(LCD_DISPLAYCONTROL | LCD_DISPLAY_D, 3);
 
-    // Attentions Sequence
-    LCD1602A_sendCommand(0x30);
-    HAL_Delay(5);
-    LCD1602A_sendCommand(0x30);
-    HAL_Delay(1);
-    LCD1602A_sendCommand(0x30);
-    HAL_Delay(8);
-    LCD1602A_sendCommand(0x20);
-    HAL_Delay(8);
-
-    LCD1602A_sendCommand(LCD_FUNCTIONSET | LCD_FUNCTION_N);
-    HAL_Delay(1);
-    LCD1602A_sendCommand(LCD_DISPLAYCONTROL);
-    HAL_Delay(1);
-    LCD1602A_sendCommand(LCD_CLEARDISPLAY);
-    HAL_Delay(3);
-    LCD1602A_sendCommand(0x04 | LCD_ENTRY_ID);
-    HAL_Delay(1);
-    LCD1602A_sendCommand(LCD_DISPLAYCONTROL | LCD_DISPLAY_D);
-    HAL_Delay(3);
+    // From now on every transfer goes through DMA queue
+    LCD1602A_startAsync();
 
+    // Any blocking transfer failed - LCD1602A_process() will find and init it again
+    if(LCD_state != LCD_STATE_PRESENT)
+    	return FALSE;
+
+    // Last blocking command - clear goes through the queue like everything else
     LCD1602A_clear();
+    LCD1602A_loadBarGlyphs();
+
     return TRUE;
 }
 
 // Set Cursor
 void LCD1602A_setCursor(uint8_t row, uint8_t col)
 {
-    uint8_t maskData;
-    maskData = (col) & 0x0F;
-    if(row == 0)
-    {
-    	maskData |= 0x80;
-    	LCD1602A_sendCommand(maskData);
-    }
-    else
-    {
-    	maskData |= 0xC0;
-    	LCD1602A_sendCommand(maskData);
-    }
+	LCD1602A_moveCursor(row, col);
 }
 
 // LCD Clear
 void LCD1602A_clear(void)
 {
-	LCD1602A_sendCommand(LCD_CLEARDISPLAY);
-	HAL_Delay(3);
+	// Clear takes 1.52 ms - next transfer waits 3 ms counted by SysTick instead of HAL_Delay()
+	if(!LCD1602A_sendCommand(LCD_CLEARDISPLAY, 3))
+		return;
+
+	// Clear also returns cursor home and fills DDRAM with spaces
+	memset(LCD1602A_frame, ' ', sizeof(LCD1602A_frame));
+	memset(LCD1602A_shown, ' ', sizeof(LCD1602A_shown));
+	LCD_cursorRow = 0;
+	LCD_cursorCol = 0;
+}
+
+// Print string at cursor position, text past the last column is cut off
+void LCD1602A_print(const char* str)
+{
+	while(*str != '\0' && LCD_cursorCol < LCD_COLS)
+	{
+		if(!LCD1602A_putChar((uint8_t)*str++))
+			return;
+	}
+}
+
+// Clear framebuffer - nothing is sent to the display until LCD1602A_flush()
+void LCD1602A_fbClear(void)
+{
+	memset(LCD1602A_frame, ' ', sizeof(LCD1602A_frame));
+}
+
+// Put string into framebuffer, returns column after last written character
+uint8_t LCD1602A_fbPutString(uint8_t row, uint8_t col, const char* str)
+{
+	if(row >= LCD_ROWS)
+		return col;
+
+	while(*str != '\0' && col < LCD_COLS)
+		LCD1602A_frame[row][col++] = (uint8_t)*str++;
+
+	return col;
+}
+
+// Put unsigned decimal into framebuffer, right aligned to width (0 - no padding), returns next column
+uint8_t LCD1602A_fbPutUint(uint8_t row, uint8_t col, uint32_t value, uint8_t width)
+{
+	char digits[10];
+	uint8_t count = 0;
+
+	if(row >= LCD_ROWS)
+		return col;
+
+	// Digits come out in reverse order
+	do
+	{
+		digits[count++] = '0' + (value % 10);
+		value /= 10;
+	} while(value != 0);
+
+	while(width > count && col < LCD_COLS)
+	{
+		LCD1602A_frame[row][col++] = ' ';
+		width--;
+	}
+
+	while(count > 0 && col < LCD_COLS)
+		LCD1602A_frame[row][col++] = (uint8_t)digits[--count];
+
+	return col;
 }
 
-// Print String On LCD - not written by me - idk what it exactly does for now, but works fine
-void LCD1602A_printf(const char* str, ...)
+// Put horizontal bar into framebuffer - 5 steps per cell, value is scaled from 0 - max
+uint8_t LCD1602A_fbPutBar(uint8_t row, uint8_t col, uint8_t cells, uint32_t value, uint32_t max)
 {
-	char stringArray[20];
-	va_list args;
+	if(row >= LCD_ROWS || max == 0)
+		return col;
+
+	if(value > max)
+		value = max;
 
-	va_start(args, str);
-	vsprintf(stringArray, str, args);
-	va_end(args);
+	// Number of lit pixel columns, rounded to nearest
+	uint32_t pixels = (value * cells * LCD_GLYPH_WIDTH + max / 2) / max;
 
-	for(uint8_t i = 0;  i < strlen(stringArray) && i < 16; i++)
+	for(uint8_t i = 0; i < cells && col < LCD_COLS; i++, col++)
 	{
-		LCD1602A_sendData((uint8_t)stringArray[i]);
+		if(pixels >= LCD_GLYPH_WIDTH)
+		{
+			LCD1602A_frame[row][col] = LCD_GLYPH_FULL;
+			pixels -= LCD_GLYPH_WIDTH;
+		}
+		else if(pixels > 0)
+		{
+			LCD1602A_frame[row][col] = LCD_GLYPH_BAR_1 + pixels - 1;
+			pixels = 0;
+		}
+		else
+		{
+			LCD1602A_frame[row][col] = ' ';
+		}
 	}
+
+	return col;
+}
+
+// Load 5x8 custom character into CGRAM slot 0 - 7 (character code is the slot number)
+uint8_t LCD1602A_loadGlyph(uint8_t slot, const uint8_t pattern[8])
+{
+	if(slot > 7)
+		return FALSE;
+
+	LCD_hold = TRUE;
+
+	uint8_t result = LCD1602A_sendCommand(LCD_SETCGRAMADDR | (slot << 3), 0);
+	for(uint8_t i = 0; i < 8 && result; i++)
+		result = LCD1602A_sendData(pattern[i] & 0x1F);
+
+	// Address counter points into CGRAM now - next flush has to set DDRAM address again
+	LCD_cursorCol = LCD_COLS;
+
+	LCD_hold = FALSE;
+	if(LCD_async)
+		LCD1602A_release();
+
+	return result;
+}
+
+// Send only cells that differ from what display shows, cursor is moved only when a gap is skipped
+// Whole frame is queued first and then goes out as one I2C transaction per changed run
+void LCD1602A_flush(void)
+{
+	LCD_hold = TRUE;
+
+	// Cells that did not fit into queue stay different and go out with next flush
+	LCD1602A_flushCells();
+
+	LCD_hold = FALSE;
+	if(LCD_async)
+		LCD1602A_release();
+}
+
+// Stop starting queued transfers, a running one finishes - I2C may be retimed once it is idle
+// (CLOCK_addHold). Resuming starts the queue again
+void LCD1602A_pause(uint8_t pause)
+{
+	LCD_paused = pause;
+	if(!pause && LCD_async)
+		LCD1602A_release();
+}
+
+// Nothing queued and nothing on the bus
+uint8_t LCD1602A_isIdle(void)
+{
+	return (LCD_queueHead == LCD_queueTail) && !LCD_inFlight && !LCD_waitTicks;
+}
+
+// Call every 1 ms (SysTick) - counts down command delay, restarts queue and watches stuck transfers
+void LCD1602A_tick(void)
+{
+	if(LCD_inFlight && ++LCD_flightTicks > LCD_TRANSFER_TIMEOUT)
+		LCD_state = LCD_STATE_FAULT;
+
+	if(LCD_waitTicks && --LCD_waitTicks == 0)
+		LCD1602A_kick();
+}
+
+// Call from HAL_I2C_MasterTxCpltCallback
+void LCD1602A_txCplt(I2C_HandleTypeDef *hi2c)
+{
+	if(hi2c != LCD1602A_hi2c || !LCD_inFlight)
+		return;
+
+	// SysTick has higher priority and also restarts the queue
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	TRACE_event(TRACE_EVENT_I2C_END, 1);
+
+	if(LCD_state == LCD_STATE_PROBING)
+	{
+		// Probe acknowledged - init is queued from LCD1602A_process()
+		LCD_state = LCD_STATE_FOUND;
+		LCD1602A_dropQueue();
+		LCD_inFlight = FALSE;
+		__set_PRIMASK(primask);
+		return;
+	}
+
+	// Delay counted in whole SysTick periods, one more because first period is partial
+	uint8_t delay = LCD_queue[LCD_queueTail].delay;
+	LCD_waitTicks = delay ? delay + 1 : 0;
+	LCD_queueTail = (LCD_queueTail + 1) & (LCD_QUEUE_SIZE - 1);
+	LCD_inFlight = FALSE;
+
+	LCD1602A_kick();
+	__set_PRIMASK(primask);
+}
+
+// Call from HAL_I2C_ErrorCallback - NACK means LCD is gone, anything else needs bus recovery
+void LCD1602A_txError(I2C_HandleTypeDef *hi2c)
+{
+	if(hi2c != LCD1602A_hi2c)
+		return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if(LCD_inFlight)
+		TRACE_event(TRACE_EVENT_I2C_END, 0);
+	LCD1602A_dropQueue();
+	LCD_inFlight = FALSE;
+	if(HAL_I2C_GetError(hi2c) == HAL_I2C_ERROR_AF)
+		LCD_state = LCD_STATE_ABSENT;
+	else
+		LCD_state = LCD_STATE_FAULT;
+
+	__set_PRIMASK(primask);
+}
+
+// Call from main loop - recovers bus, probes both addresses and re-inits LCD after hot-plug
+void LCD1602A_process(void)
+{
+	if(!LCD_async)
+		return;
+
+	switch(LCD_state)
+	{
+	case LCD_STATE_FAULT:
+		LCD1602A_recoverBus();
+		LCD_state = LCD_STATE_ABSENT;
+		LCD_probeTick = HAL_GetTick();
+		break;
+
+	case LCD_STATE_ABSENT:
+		if((HAL_GetTick() - LCD_probeTick) >= LCD_PROBE_PERIOD)
+		{
+			// Single backlight byte through DMA queue - ACK or NACK comes back in callbacks
+			uint8_t backlight = LCD_BK_LIGHT;
+
+			LCD_probeTick = HAL_GetTick();
+			LCD_I2C_SLAVE_ADDRESS = LCD_I2C_SLAVE_ADDRESSES[LCD_probeIndex];
+			LCD_probeIndex = (LCD_probeIndex + 1) % LCD_ADDRESS_COUNT;
+			LCD_state = LCD_STATE_PROBING;
+			LCD1602A_enqueue(&backlight, 1, 0);
+		}
+		break;
+
+	case LCD_STATE_FOUND:
+		LCD_state = LCD_STATE_PRESENT;
+		LCD1602A_queueInit();
+		break;
+
+	default:
+		break;
+	}
+}
+
+// Current device state (LCD_STATE_x)
+uint8_t LCD1602A_getState(void)
+{
+	return LCD_state;
+}
+
+// TRUE when init could read busy flag back, FALSE when fixed delays are used
+uint8_t LCD1602A_hasBusyFlag(void)
+{
+	return LCD_busyFlag;
 }
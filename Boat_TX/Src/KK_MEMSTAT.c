@@ -0,0 +1,124 @@
+/*
+Library for:				RAM usage - stack high-water mark and heap statistics
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32F446RETX_FLASH.ld memory layout
+							- newlib _sbrk (sysmem.c)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_MEMSTAT.h"
+#include "KK_TELEMETRY.h"
+#ifdef USE_FREERTOS
+#include "KK_TASK.h"
+#include <string.h>
+#endif
+
+/* Linker symbols - only addresses are meaningful */
+
+extern uint32_t _sdata;
+extern uint32_t _ebss;
+extern uint32_t _estack;
+extern uint8_t _Min_Heap_Size;
+extern uint8_t _Min_Stack_Size;
+extern char end asm("end");
+
+// sysmem.c, increment 0 returns current heap top
+extern char *_sbrk(int incr);
+
+/* Static function prototypes */
+
+static uint32_t *MEMSTAT_heapTop(void);
+static uint32_t *MEMSTAT_stackBottom(void);
+static void MEMSTAT_put32(uint8_t *dst, uint32_t value);
+#ifdef USE_FREERTOS
+static void MEMSTAT_reportTasks(void);
+#endif
+
+/* Functions */
+
+static uint32_t *MEMSTAT_heapTop(void)
+{
+	return (uint32_t *)(((uintptr_t)_sbrk(0) + 3) & ~(uintptr_t)3);
+}
+
+// Lowest word written by the stack since reset
+static uint32_t *MEMSTAT_stackBottom(void)
+{
+	uint32_t *word = MEMSTAT_heapTop();
+
+	while(word < &_estack && *word == MEMSTAT_PAINT)
+		word++;
+
+	return word;
+}
+
+static void MEMSTAT_put32(uint8_t *dst, uint32_t value)
+{
+	dst[0] = (uint8_t)(value);
+	dst[1] = (uint8_t)(value >> 8);
+	dst[2] = (uint8_t)(value >> 16);
+	dst[3] = (uint8_t)(value >> 24);
+}
+
+uint32_t MEMSTAT_stackUsed(void)
+{
+	return (uint32_t)((uint8_t *)&_estack - (uint8_t *)MEMSTAT_stackBottom());
+}
+
+void MEMSTAT_get(MEMSTAT_Usage *usage)
+{
+	uint32_t *heapTop = MEMSTAT_heapTop();
+	uint32_t *stackBottom = MEMSTAT_stackBottom();
+
+	usage->staticSize = (uint32_t)((uint8_t *)&_ebss - (uint8_t *)&_sdata);
+	usage->heapUsed = (uint32_t)((char *)heapTop - &end);
+	usage->heapReserved = (uint32_t)(uintptr_t)&_Min_Heap_Size;
+	usage->stackUsed = (uint32_t)((uint8_t *)&_estack - (uint8_t *)stackBottom);
+	usage->stackReserved = (uint32_t)(uintptr_t)&_Min_Stack_Size;
+	usage->freeLargest = (uint32_t)((uint8_t *)stackBottom - (uint8_t *)heapTop);
+}
+
+#ifdef USE_FREERTOS
+// One STACK telemetry record per task
+static void MEMSTAT_reportTasks(void)
+{
+	const TASK_Task *task;
+	uint8_t payload[TELEMETRY_STACK_SIZE];
+
+	for(uint8_t i = 0; (task = TASK_get(i)) != NULL; i++)
+	{
+		payload[0] = i;
+		MEMSTAT_put32(&payload[1], TASK_stackUsed(task));
+		MEMSTAT_put32(&payload[5], TASK_STACK_SIZE * sizeof(StackType_t));
+		memset(&payload[9], 0, TELEMETRY_STACK_NAME);
+		strncpy((char *)&payload[9], task->name, TELEMETRY_STACK_NAME);
+
+		TELEMETRY_send(TELEMETRY_TYPE_STACK, payload, sizeof(payload));
+	}
+}
+#endif
+
+// One MEMORY telemetry record, and one STACK record per task in the FreeRTOS build
+void MEMSTAT_report(void)
+{
+	MEMSTAT_Usage usage;
+	uint8_t payload[TELEMETRY_MEMORY_SIZE];
+
+	MEMSTAT_get(&usage);
+
+	MEMSTAT_put32(&payload[0], usage.staticSize);
+	MEMSTAT_put32(&payload[4], usage.heapUsed);
+	MEMSTAT_put32(&payload[8], usage.heapReserved);
+	MEMSTAT_put32(&payload[12], usage.stackUsed);
+	MEMSTAT_put32(&payload[16], usage.stackReserved);
+	MEMSTAT_put32(&payload[20], usage.freeLargest);
+
+	TELEMETRY_send(TELEMETRY_TYPE_MEMORY, payload, sizeof(payload));
+
+#ifdef USE_FREERTOS
+	MEMSTAT_reportTasks();
+#endif
+}
@@ -0,0 +1,228 @@
+/*
+Library for:				Cooperative tasks - stackless protothreads with timer and event waits
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Adam Dunkels, Protothreads: Simplifying Event-Driven Programming
+							  of Memory-Constrained Embedded Systems
+							- PM0214 Cortex-M4 Programming Manual, 3.10.11 WFI
+							- FreeRTOS Reference Manual, static allocation and RTOS on ARM Cortex-M
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_TASK.h"
+
+#ifndef USE_FREERTOS
+
+/* Functions */
+
+void TASK_eventInit(TASK_Event *event)
+{
+	*event = 0;
+}
+
+// Called from HAL callbacks (DMA complete, EXTI) - a single byte store, no locking needed
+void TASK_signal(TASK_Event *event)
+{
+	*event = 1;
+}
+
+// Rewind every task to its first line, periods count from now
+void TASK_start(TASK_Task *tasks, uint8_t count)
+{
+	for(uint8_t i = 0; i < count; i++){
+		tasks[i].line = 0;
+		tasks[i].state = TASK_YIELDED;
+		tasks[i].wake = TASK_NOW();
+		tasks[i].release = tasks[i].wake;
+	}
+}
+
+// One round over all tasks - returns the number of tasks still running, the core sleeps
+// until the next interrupt when none of them is ready
+uint8_t TASK_schedule(TASK_Task *tasks, uint8_t count)
+{
+	uint8_t running = 0;
+	uint8_t ready = 0;
+
+	for(uint8_t i = 0; i < count; i++){
+		if(tasks[i].state == TASK_DONE)
+			continue;
+
+		tasks[i].state = tasks[i].function(&tasks[i]);
+
+		if(tasks[i].state != TASK_DONE)
+			running++;
+		if(tasks[i].state == TASK_YIELDED)
+			ready++;
+	}
+
+	if(running && ! ready)
+		TASK_IDLE();
+
+	return running;
+}
+
+#else
+
+/* Kernel objects - configSUPPORT_DYNAMIC_ALLOCATION is 0 */
+
+static StaticTask_t task_idleTcb;
+static StackType_t task_idleStack[configMINIMAL_STACK_SIZE];
+
+#if configUSE_TIMERS
+static StaticTask_t task_timerTcb;
+static StackType_t task_timerStack[configTIMER_TASK_STACK_DEPTH];
+#endif
+
+#ifdef USE_HAL_DRIVER
+
+// Port handlers go into a RAM copy of the vector table, CubeMX keeps its SVC_Handler and PendSV_Handler
+extern void vPortSVCHandler(void);
+extern void xPortPendSVHandler(void);
+
+#define TASK_VECTORS				(16 + FMPI2C1_ER_IRQn + 1)	// Cortex-M4 exceptions + STM32F446 IRQs
+
+static uint32_t task_vectors[TASK_VECTORS] __attribute__((aligned(512)));
+
+#endif
+
+/* Library variables */
+
+static TASK_Task *task_list;
+static uint8_t task_count;
+
+/* Static function prototypes */
+
+static void TASK_entry(void *arg);
+#ifdef USE_HAL_DRIVER
+static void TASK_installVectors(void);
+#endif
+
+/* Functions */
+
+void TASK_eventInit(TASK_Event *event)
+{
+	event->handle = xSemaphoreCreateBinaryStatic(&event->buffer);
+}
+
+// From ISR gives the semaphore and switches to the woken task on exception return
+void TASK_signal(TASK_Event *event)
+{
+#ifdef USE_HAL_DRIVER
+	if(__get_IPSR() != 0U){
+		BaseType_t woken = pdFALSE;
+		xSemaphoreGiveFromISR(event->handle, &woken);
+		portYIELD_FROM_ISR(woken);
+		return;
+	}
+#endif
+	xSemaphoreGive(event->handle);
+}
+
+// Task function returning TASK_DONE deletes its FreeRTOS task
+static void TASK_entry(void *arg)
+{
+	TASK_Task *task = (TASK_Task *)arg;
+
+	task->release = xTaskGetTickCount();
+	task->state = task->function(task);
+	vTaskDelete(NULL);
+}
+
+#ifdef USE_HAL_DRIVER
+static void TASK_installVectors(void)
+{
+	const uint32_t *flash = (const uint32_t *)(uintptr_t)SCB->VTOR;
+
+	for(uint16_t i = 0; i < TASK_VECTORS; i++)
+		task_vectors[i] = flash[i];
+
+	task_vectors[SVCall_IRQn + 16] = (uint32_t)(uintptr_t)vPortSVCHandler;
+	task_vectors[PendSV_IRQn + 16] = (uint32_t)(uintptr_t)xPortPendSVHandler;
+
+	__disable_irq();
+	SCB->VTOR = (uint32_t)(uintptr_t)task_vectors;
+	__DSB();
+	__enable_irq();
+}
+#endif
+
+// Creates one FreeRTOS task per entry and starts the kernel - does not return
+void TASK_start(TASK_Task *tasks, uint8_t count)
+{
+	task_list = tasks;
+	task_count = count;
+
+	for(uint8_t i = 0; i < count; i++){
+		tasks[i].state = TASK_YIELDED;
+		tasks[i].handle = xTaskCreateStatic(TASK_entry, tasks[i].name, TASK_STACK_SIZE, &tasks[i],
+											tasks[i].priority, tasks[i].stack, &tasks[i].tcb);
+	}
+
+#ifdef USE_HAL_DRIVER
+	TASK_installVectors();
+#endif
+
+	vTaskStartScheduler();
+}
+
+// Kernel schedules the tasks, nothing to do in the main loop
+uint8_t TASK_schedule(TASK_Task *tasks, uint8_t count)
+{
+	(void)tasks;
+
+	return count;
+}
+
+// Task table given to TASK_start, NULL past the end
+const TASK_Task *TASK_get(uint8_t index)
+{
+	return index < task_count ? &task_list[index] : NULL;
+}
+
+// Deepest use of the task stack in bytes - the kernel fills new stacks with a known value, 0 once
+// the task returned TASK_DONE and was deleted
+uint32_t TASK_stackUsed(const TASK_Task *task)
+{
+	if(task->state == TASK_DONE)
+		return 0;
+
+	return (TASK_STACK_SIZE - uxTaskGetStackHighWaterMark(task->handle)) * sizeof(StackType_t);
+}
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *size)
+{
+	*tcb = &task_idleTcb;
+	*stack = task_idleStack;
+	*size = configMINIMAL_STACK_SIZE;
+}
+
+#if configUSE_TIMERS
+void vApplicationGetTimerTaskMemory(StaticTask_t **tcb, StackType_t **stack, uint32_t *size)
+{
+	*tcb = &task_timerTcb;
+	*stack = task_timerStack;
+	*size = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
+
+#ifdef USE_HAL_DRIVER
+// SysTick is the HAL and the kernel tick - HAL_RCC_ClockConfig calls this on every CLOCK_setProfile,
+// the period stays 1 ms and the priority stays at the kernel level instead of TICK_INT_PRIORITY
+HAL_StatusTypeDef HAL_InitTick(uint32_t TickPriority)
+{
+	(void)TickPriority;
+
+	if(SysTick_Config(SystemCoreClock / configTICK_RATE_HZ) != 0U)
+		return HAL_ERROR;
+
+	NVIC_SetPriority(SysTick_IRQn, configLIBRARY_LOWEST_INTERRUPT_PRIORITY);
+	uwTickPrio = configLIBRARY_LOWEST_INTERRUPT_PRIORITY;
+
+	return HAL_OK;
+}
+#endif
+
+#endif
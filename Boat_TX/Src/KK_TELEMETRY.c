@@ -0,0 +1,181 @@
+/*
+Library for:				Binary telemetry over KK_LOGGER (COBS framing)
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- S. Cheshire, M. Baker - Consistent Overhead Byte Stuffing
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/* Includes */
+
+#include "KK_TELEMETRY.h"
+#include "KK_RAMFUNC.h"
+
+#ifdef USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+/* Private variables */
+
+static uint8_t telemetry_seq = 0;
+
+/* Static function prototypes */
+
+static uint16_t TELEMETRY_crc16(const uint8_t *data, uint8_t len);
+static uint8_t TELEMETRY_cobs(const uint8_t *src, uint8_t len, uint8_t *dst);
+static void TELEMETRY_put32(uint8_t *dst, uint32_t value);
+
+/* Functions */
+
+// Telemetry Initialization function - first frame tells host which board is talking
+void TELEMETRY_init(uint8_t source)
+{
+	telemetry_seq = 0;
+	TELEMETRY_sendEvent(TELEMETRY_EVENT_BOOT, source);
+}
+
+// Microseconds since boot - SysTick counts down from LOAD within every millisecond
+uint32_t TELEMETRY_timestamp(void)
+{
+	uint32_t tick;
+	uint32_t val;
+
+	// Read again when SysTick wrapped between reads
+	do
+	{
+		tick = HAL_GetTick();
+		val = SysTick->VAL;
+	} while(tick != HAL_GetTick());
+
+	return tick * 1000 + ((SysTick->LOAD - val) * 1000) / (SysTick->LOAD + 1);
+}
+
+// CRC-16/CCITT-FALSE - bit loop over every frame byte, runs from SRAM
+RAMFUNC static uint16_t TELEMETRY_crc16(const uint8_t *data, uint8_t len)
+{
+	uint16_t crc = 0xFFFF;
+
+	while(len--)
+	{
+		crc ^= (uint16_t)(*data++) << 8;
+		for(uint8_t i = 0; i < 8; i++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	}
+	return crc;
+}
+
+// COBS encode - removes every 0x00 so it can delimit frames, returns encoded length
+RAMFUNC static uint8_t TELEMETRY_cobs(const uint8_t *src, uint8_t len, uint8_t *dst)
+{
+	uint8_t code_idx = 0;
+	uint8_t out = 1;
+	uint8_t code = 1;
+
+	for(uint8_t i = 0; i < len; i++)
+	{
+		if(src[i] == 0)
+		{
+			dst[code_idx] = code;
+			code_idx = out++;
+			code = 1;
+		}
+		else
+		{
+			dst[out++] = src[i];
+			code++;
+		}
+	}
+	dst[code_idx] = code;
+
+	return out;
+}
+
+static void TELEMETRY_put32(uint8_t *dst, uint32_t value)
+{
+	dst[0] = (uint8_t)(value);
+	dst[1] = (uint8_t)(value >> 8);
+	dst[2] = (uint8_t)(value >> 16);
+	dst[3] = (uint8_t)(value >> 24);
+}
+
+// Build, encode and queue one frame - returns 0 when logger dropped it
+// USE_FREERTOS: sequence number, timestamp and LOGGER_write are taken with the scheduler suspended,
+// so frames of preempting tasks reach the logger in sequence order
+uint8_t TELEMETRY_send(uint8_t type, const uint8_t *payload, uint8_t len)
+{
+	uint8_t raw[TELEMETRY_MAX_FRAME];
+	uint8_t encoded[TELEMETRY_MAX_FRAME + 2];
+
+	if(len > TELEMETRY_MAX_PAYLOAD)
+		return 0;
+
+#ifdef USE_FREERTOS
+	uint8_t scheduler = xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+	if(scheduler)
+		vTaskSuspendAll();
+#endif
+
+	raw[0] = type;
+	raw[1] = telemetry_seq++;
+	TELEMETRY_put32(&raw[2], TELEMETRY_timestamp());
+	memcpy(&raw[TELEMETRY_HEADER_SIZE], payload, len);
+
+	uint16_t crc = TELEMETRY_crc16(raw, TELEMETRY_HEADER_SIZE + len);
+	raw[TELEMETRY_HEADER_SIZE + len] = (uint8_t)crc;
+	raw[TELEMETRY_HEADER_SIZE + len + 1] = (uint8_t)(crc >> 8);
+
+	// Frames are shorter than 254 B, so COBS adds exactly one byte
+	uint8_t size = TELEMETRY_cobs(raw, TELEMETRY_HEADER_SIZE + len + 2, encoded);
+	encoded[size++] = TELEMETRY_DELIMITER;
+
+	uint8_t written = LOGGER_write(encoded, size);
+
+#ifdef USE_FREERTOS
+	if(scheduler)
+		xTaskResumeAll();
+#endif
+	return written;
+}
+
+// Control frame sent (TX) or received (RX)
+uint8_t TELEMETRY_sendControl(uint8_t speed, uint8_t direction, uint8_t flags)
+{
+	uint8_t payload[3] = { speed, direction, flags };
+
+	return TELEMETRY_send(TELEMETRY_TYPE_CONTROL, payload, sizeof(payload));
+}
+
+// Link counters - TX: packets sent and acknowledged, RX: packets received
+uint8_t TELEMETRY_sendLink(uint32_t packets, uint32_t acked)
+{
+	uint8_t payload[12];
+
+	TELEMETRY_put32(&payload[0], packets);
+	TELEMETRY_put32(&payload[4], acked);
+	TELEMETRY_put32(&payload[8], LOGGER_getDropped());
+
+	return TELEMETRY_send(TELEMETRY_TYPE_LINK, payload, sizeof(payload));
+}
+
+// Main loop timing in microseconds
+uint8_t TELEMETRY_sendLoop(uint32_t loopTime, uint32_t loopTimeMax)
+{
+	uint8_t payload[8];
+
+	TELEMETRY_put32(&payload[0], loopTime);
+	TELEMETRY_put32(&payload[4], loopTimeMax);
+
+	return TELEMETRY_send(TELEMETRY_TYPE_LOOP, payload, sizeof(payload));
+}
+
+// Single event with argument
+uint8_t TELEMETRY_sendEvent(uint8_t event, uint32_t arg)
+{
+	uint8_t payload[5];
+
+	payload[0] = event;
+	TELEMETRY_put32(&payload[1], arg);
+
+	return TELEMETRY_send(TELEMETRY_TYPE_EVENT, payload, sizeof(payload));
+}
@@ -31,15 +31,56 @@
 /* USER CODE BEGIN Includes */
 #include "NRF24.h"
 #include "KK_LCD1602A.h"
+#include "KK_DISPLAY.h"
+#include "KK_LOGGER.h"
+#include "KK_TELEMETRY.h"
+#include "KK_PROFILER.h"
+#include "KK_TRACE.h"
+#include "KK_JOYSTICK.h"
+#include "KK_BENCH.h"
+#include "KK_MEMSTAT.h"
+#include "KK_CLOCK.h"
+#include "KK_TASK.h"
+#include "KK_BUS.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN PTD */
+// Bus messages - filled in place in BUS_TOPIC slots, consumers get pointers into them
+typedef struct
+{
+	uint16_t raw[2];				// ADC1 speed and direction channels
+} AdcMsg;
+
+typedef struct
+{
+	uint8_t speed;					// 0 - 100 %
+	uint8_t direction;
+	uint8_t sequence;				// lets host tools pair TX and RX traces
+} ControlMsg;						// radio payload as is
 
+typedef struct
+{
+	const ControlMsg *frame;		// slot the radio sent, reused once frame->sequence != sequence
+	uint8_t sequence;
+	uint8_t ack;					// 1 - frame acknowledged
+	uint16_t history;				// last 16 transmissions, 1 bit each, LSB newest
+	uint32_t sent;
+	uint32_t acked;
+	uint32_t loop_us;				// frame taken to radio done, includes air time
+	uint32_t loop_us_max;
+} LinkMsg;
+
+_Static_assert(sizeof(ControlMsg) == PAYLOAD_SIZE, "ControlMsg is the radio payload");
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+#define TELEMETRY_PERIOD 1000
+#define IDLE_CLOCK_TIMEOUT 5000
+#define CONTROL_PERIOD 100
+#define DISPLAY_PERIOD 20
+#define BUTTON_DEBOUNCE 200
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -51,19 +92,263 @@
 
 /* USER CODE BEGIN PV */
 const uint64_t tx_pipe_addr = 		0x11223344AA;
-uint8_t my_tx_data[MAX_PAYLOAD_SIZE + 2];
 uint16_t Joystick[2];
+
+// Producers: control - adc, control; radio - link
+BUS_TOPIC(bus_adc, AdcMsg);
+BUS_TOPIC(bus_control, ControlMsg);
+BUS_TOPIC(bus_link, LinkMsg);
+
+static TASK_Event frame_ready;
+static TASK_Event button_pressed;
+static TASK_Event radio_irq;
+static TASK_Event link_ready;
+static TASK_Event command_ready;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 /* USER CODE BEGIN PFP */
-
+static uint8_t radioTask(TASK_Task *t);
+static uint8_t controlTask(TASK_Task *t);
+static uint8_t displayTask(TASK_Task *t);
+static uint8_t loggerTask(TASK_Task *t);
+static uint8_t buttonTask(TASK_Task *t);
+static uint8_t commandTask(TASK_Task *t);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+// Tasks resume where they waited - state that has to survive a wait is static
+
+// Sends every control frame straight from its bus slot, publishes link state after the ACK
+static uint8_t radioTask(TASK_Task *t)
+{
+	static BUS_Reader frames = BUS_READER(bus_control);
+	static const ControlMsg *frame;
+	static uint32_t loop_start_us;
+	static uint32_t loop_us_max;
+	static uint32_t sent;
+	static uint32_t acked;
+	static uint16_t history;
+
+	TASK_BEGIN(t);
+
+	for(;;){
+		TASK_WAIT_EVENT(t, frame_ready);
+		if((frame = BUS_read(&frames)) == NULL)
+			continue;
+
+		// Profiler zones cover CPU time only, power-up and air time are spent in other tasks or WFI
+		{
+			loop_start_us = TELEMETRY_timestamp();
+			TRACE_event(TRACE_EVENT_RADIO_TX, TRACE_RADIO_ARG((const uint8_t *)frame));
+			TASK_CLEAR(radio_irq);
+			PROFILER_BEGIN(PROFILER_ZONE_NRF24_WRITE_START);
+			NRF24_writeStart(frame, PAYLOAD_SIZE);
+			PROFILER_END(PROFILER_ZONE_NRF24_WRITE_START);
+		}
+
+		// CE stays high until TX_DS pulls the IRQ line - power-up takes up to 1.5 ms. Without the
+		// IRQ wire the timeout ends the wait and NRF24_writeFinish still reads TX_DS
+		TASK_WAIT_EVENT_TIMEOUT(t, radio_irq, NRF24_TX_TIMEOUT);
+
+		{
+			PROFILER_BEGIN(PROFILER_ZONE_NRF24_WRITE_FINISH);
+			uint8_t ack = NRF24_writeFinish();
+			PROFILER_END(PROFILER_ZONE_NRF24_WRITE_FINISH);
+			TRACE_event(TRACE_EVENT_RADIO_TX_DONE, ack);
+
+			sent++;
+			acked += ack;
+			history = (history << 1) | ack;
+
+			uint32_t loop_us = TELEMETRY_timestamp() - loop_start_us;
+			if(loop_us > loop_us_max)
+				loop_us_max = loop_us;
+
+			LinkMsg *link = BUS_claim(&bus_link);
+			link->frame = frame;
+			link->sequence = frame->sequence;
+			link->ack = ack;
+			link->history = history;
+			link->sent = sent;
+			link->acked = acked;
+			link->loop_us = loop_us;
+			link->loop_us_max = loop_us_max;
+			BUS_publish(&bus_link);
+			TASK_signal(&link_ready);
+		}
+	}
+
+	TASK_END(t);
+}
+
+// Joystick snapshot and control frame every CONTROL_PERIOD, then the clock policy
+static uint8_t controlTask(TASK_Task *t)
+{
+	static uint32_t stick_moved;
+	static uint8_t sequence;
+	static uint8_t moving;
+
+	TASK_BEGIN(t);
+
+	stick_moved = HAL_GetTick();
+
+	for(;;){
+		{
+			PROFILER_BEGIN(PROFILER_ZONE_LOOP);
+			TRACE_event(TRACE_EVENT_TASK_START, PROFILER_ZONE_LOOP);
+
+			// ADC DMA keeps overwriting Joystick[] - the snapshot is the only copy on the way to the radio
+			AdcMsg *adc = BUS_claim(&bus_adc);
+			adc->raw[0] = Joystick[0];
+			adc->raw[1] = Joystick[1];
+			BUS_publish(&bus_adc);
+
+			// mnozymy przez wspolczynnik zepsutych Chinskich joysticków
+			ControlMsg *frame = BUS_claim(&bus_control);
+			frame->speed = JOYSTICK_toPercent(adc->raw[0]);
+			frame->direction = JOYSTICK_toPercent(adc->raw[1]);
+			frame->sequence = ++sequence;
+			moving = frame->speed < 40 || frame->speed > 60 || frame->direction < 40 || frame->direction > 60;
+			BUS_publish(&bus_control);
+			TASK_signal(&frame_ready);
+
+			PROFILER_END(PROFILER_ZONE_LOOP);
+			TRACE_event(TRACE_EVENT_TASK_STOP, PROFILER_ZONE_LOOP);
+		}
+
+		// Radio goes first, a profile switch retimes SPI
+		TASK_YIELD(t);
+
+		// Sprint while the sticks move, drop to HSI when they rest in the centre
+		if(moving){
+			stick_moved = HAL_GetTick();
+			CLOCK_setProfile(CLOCK_PROFILE_PERFORMANCE);
+		}
+		else if((HAL_GetTick() - stick_moved) > IDLE_CLOCK_TIMEOUT){
+			CLOCK_setProfile(CLOCK_PROFILE_LOW_POWER);
+		}
+
+		TASK_SLEEP_PERIOD(t, CONTROL_PERIOD);
+	}
+
+	TASK_END(t);
+}
+
+// Display has its own refresh rate and shows link state also when nothing gets through,
+// LCD transfers run on I2C DMA and SysTick in the background
+static uint8_t displayTask(TASK_Task *t)
+{
+	static DISPLAY_Telemetry display_data;
+
+	TASK_BEGIN(t);
+
+	for(;;){
+		TRACE_event(TRACE_EVENT_TASK_START, PROFILER_ZONE_DISPLAY);
+		PROFILER_BEGIN(PROFILER_ZONE_DISPLAY);
+
+		// Newest state only, frames published between refreshes are not shown
+		const ControlMsg *frame = BUS_latest(&bus_control);
+		if(frame != NULL){
+			display_data.speed = frame->speed;
+			display_data.direction = frame->direction;
+		}
+		const LinkMsg *link = BUS_latest(&bus_link);
+		if(link != NULL){
+			display_data.linkHistory = link->history;
+			display_data.packetsSent = link->sent;
+			display_data.packetsAcked = link->acked;
+			display_data.loopTime = link->loop_us / 1000;
+			display_data.loopTimeMax = link->loop_us_max / 1000;
+		}
+		DISPLAY_process(&display_data);
+
+		PROFILER_END(PROFILER_ZONE_DISPLAY);
+		TRACE_event(TRACE_EVENT_TASK_STOP, PROFILER_ZONE_DISPLAY);
+
+		TASK_SLEEP(t, DISPLAY_PERIOD);
+	}
+
+	TASK_END(t);
+}
+
+// Control frame with its ACK for every transmission, link and loop frames every TELEMETRY_PERIOD
+static uint8_t loggerTask(TASK_Task *t)
+{
+	static BUS_Reader links = BUS_READER(bus_link);
+	static uint32_t telemetry_last;
+
+	TASK_BEGIN(t);
+
+	telemetry_last = HAL_GetTick();
+
+	for(;;){
+		TASK_WAIT_EVENT(t, link_ready);
+
+		const LinkMsg *link = BUS_read(&links);
+		if(link == NULL)
+			continue;
+
+		PROFILER_BEGIN(PROFILER_ZONE_TELEMETRY);
+		if(link->frame->sequence == link->sequence)
+			TELEMETRY_sendControl(link->frame->speed, link->frame->direction, link->ack ? TELEMETRY_CONTROL_ACKED : 0);
+
+		if((HAL_GetTick() - telemetry_last) >= TELEMETRY_PERIOD){
+			telemetry_last = HAL_GetTick();
+			TELEMETRY_sendLink(link->sent, link->acked);
+			TELEMETRY_sendLoop(link->loop_us, link->loop_us_max);
+		}
+		PROFILER_END(PROFILER_ZONE_TELEMETRY);
+	}
+
+	TASK_END(t);
+}
 
+// B1 EXTI - one page per press, contact bounce inside BUTTON_DEBOUNCE is dropped
+static uint8_t buttonTask(TASK_Task *t)
+{
+	TASK_BEGIN(t);
+
+	for(;;){
+		TASK_WAIT_EVENT(t, button_pressed);
+		DISPLAY_nextPage();
+
+		TASK_SLEEP(t, BUTTON_DEBOUNCE);
+		TASK_CLEAR(button_pressed);
+	}
+
+	TASK_END(t);
+}
+
+// Host requests over USART2 RX
+static uint8_t commandTask(TASK_Task *t)
+{
+	static uint8_t command;
+
+	TASK_BEGIN(t);
+
+	for(;;){
+		TASK_WAIT_EVENT(t, command_ready);
+
+		while((command = LOGGER_getCommand()) != LOGGER_CMD_NONE){
+			switch(command){
+			case LOGGER_CMD_PROFILE:
+				PROFILER_report();
+				break;
+			case LOGGER_CMD_PROFILE_RESET:
+				PROFILER_reset();
+				break;
+			case LOGGER_CMD_MEMORY:
+				MEMSTAT_report();
+				break;
+			}
+		}
+	}
+
+	TASK_END(t);
+}
 /* USER CODE END 0 */
 
 /**
@@ -100,40 +385,73 @@ int main(void)
   MX_ADC1_Init();
   MX_I2C1_Init();
   /* USER CODE BEGIN 2 */
+  // Events exist before the interrupts signalling them are enabled
+  TASK_eventInit(&frame_ready);
+  TASK_eventInit(&button_pressed);
+  TASK_eventInit(&radio_irq);
+  TASK_eventInit(&link_ready);
+  TASK_eventInit(&command_ready);
+
+  LOGGER_init(&huart2);
+#ifdef BENCHMARK
+  BENCH_suite();
+#endif
+  TELEMETRY_init(TELEMETRY_SOURCE_TX);
+  PROFILER_init();
+  TRACE_init(TRACE_SOURCE_TX);
   HAL_ADC_Start_DMA(&hadc1, (uint32_t*)Joystick, 2);
   NRF24_init(&hspi2);
 
   NRF24_openWritingPipe(tx_pipe_addr);
 
+  // nRF24 IRQ wakes radioTask at TX_DS instead of a poll once per tick
+  GPIO_InitTypeDef radio_irq_pin = { .Pin = NRF24_IRQ_Pin, .Mode = GPIO_MODE_IT_FALLING, .Pull = GPIO_PULLUP };
+  HAL_GPIO_Init(NRF24_IRQ_GPIO_Port, &radio_irq_pin);
+  HAL_NVIC_SetPriority(NRF24_IRQ_EXTI_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(NRF24_IRQ_EXTI_IRQn);
+
   if(! LCD1602A_init(&hi2c1)){
-	  uint8_t error_msg[] = "Couldn't connect to LCD Display\r\n";
-	  HAL_UART_Transmit(&huart2, error_msg, sizeof(error_msg), 100);
+	  TELEMETRY_sendEvent(TELEMETRY_EVENT_LCD_MISSING, 0);
   }
+  DISPLAY_init();
+
+  CLOCK_init();
+  CLOCK_addSpi(&hspi2);
+  CLOCK_addUart(&huart2);
+  CLOCK_addI2c(&hi2c1);
+  CLOCK_addHold(LCD1602A_pause);
+
+#ifdef USE_FREERTOS
+  // Preemption levels from the .ioc, kernel masks 5 and below - EXTI signals the radio and button
+  // tasks, USART2 RX the command task
+  HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+  HAL_NVIC_SetPriority(NRF24_IRQ_EXTI_IRQn, 5, 0);
+  HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 5, 0);
+  HAL_NVIC_SetPriority(DMA1_Stream7_IRQn, 5, 0);
+  HAL_NVIC_SetPriority(I2C1_EV_IRQn, 5, 0);
+  HAL_NVIC_SetPriority(I2C1_ER_IRQn, 5, 0);
+  HAL_NVIC_SetPriority(EXTI15_10_IRQn, 6, 0);
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 7, 0);
+  HAL_NVIC_SetPriority(USART2_IRQn, 7, 0);
+#endif
+
+  // Most urgent first - bare-metal runs them in this order, FreeRTOS by priority
+  static TASK_Task tasks[] = {
+	  TASK_INIT(radioTask, TASK_PRIORITY_RADIO),
+	  TASK_INIT(controlTask, TASK_PRIORITY_CONTROL),
+	  TASK_INIT(buttonTask, TASK_PRIORITY_CONTROL),
+	  TASK_INIT(displayTask, TASK_PRIORITY_DISPLAY),
+	  TASK_INIT(loggerTask, TASK_PRIORITY_TELEMETRY),
+	  TASK_INIT(commandTask, TASK_PRIORITY_TELEMETRY),
+  };
+  TASK_start(tasks, sizeof(tasks) / sizeof(tasks[0]));
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-	  // mnozymy przez wspolczynnik zepsutych Chinskich joysticków
-	  my_tx_data[0] = (uint8_t)((Joystick[0] * 100.0) / 4095.0);
-	  my_tx_data[0] = (uint8_t)((my_tx_data[0] - 43) * (100.0 / 57.0));
-	  my_tx_data[1] = (uint8_t)((Joystick[1] * 100.0) / 4095.0);
-	  my_tx_data[1] = (uint8_t)((my_tx_data[1] - 43) * (100.0 / 57.0));
-
-	  if(NRF24_write(my_tx_data, PAYLOAD_SIZE)){
-		  my_tx_data[PAYLOAD_SIZE] = '\r';
-		  my_tx_data[PAYLOAD_SIZE + 1] = '\n';
-		  HAL_UART_Transmit(&huart2, my_tx_data, PAYLOAD_SIZE + 2, 100);
-
-		  LCD1602A_clear();
-		  LCD1602A_setCursor(0, 0);
-		  LCD1602A_printf("Speed = %u", my_tx_data[0]);
-		  LCD1602A_setCursor(1, 0);
-		  LCD1602A_printf("Direction = %u", my_tx_data[1]);
-	  }
-
-	  HAL_Delay(100);
+	  TASK_schedule(tasks, sizeof(tasks) / sizeof(tasks[0]));
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -186,6 +504,39 @@ void SystemClock_Config(void)
 }
 
 /* USER CODE BEGIN 4 */
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	LCD1602A_txCplt(hi2c);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	LCD1602A_txError(hi2c);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	LOGGER_txCplt(huart);
+}
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+	LOGGER_rxCplt(huart);
+	TASK_signal(&command_ready);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	LOGGER_error(huart);
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+	if(GPIO_Pin == NRF24_IRQ_Pin)
+		TASK_signal(&radio_irq);
+	else if(GPIO_Pin == B1_Pin)
+		TASK_signal(&button_pressed);
+}
 
 /* USER CODE END 4 */
 
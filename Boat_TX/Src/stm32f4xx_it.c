@@ -23,6 +23,15 @@
 #include "stm32f4xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "KK_LCD1602A.h"
+#include "KK_TRACE.h"
+#ifdef USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+// GCC/ARM_CM4F port.c
+extern void xPortSysTickHandler(void);
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -58,6 +67,10 @@
 /* External variables --------------------------------------------------------*/
 extern DMA_HandleTypeDef hdma_adc1;
 /* USER CODE BEGIN EV */
+extern UART_HandleTypeDef huart2;
+extern DMA_HandleTypeDef hdma_usart2_tx;
+extern I2C_HandleTypeDef hi2c1;
+extern DMA_HandleTypeDef hdma_i2c1_tx;
 
 /* USER CODE END EV */
 
@@ -186,6 +199,11 @@ void SysTick_Handler(void)
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
+#ifdef USE_FREERTOS
+  if(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+    xPortSysTickHandler();
+#endif
+  LCD1602A_tick();
 
   /* USER CODE END SysTick_IRQn 1 */
 }
@@ -203,15 +221,86 @@ void SysTick_Handler(void)
 void DMA2_Stream0_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA2_Stream0_IRQn 0 */
+  TRACE_IRQ_ENTER();
 
   /* USER CODE END DMA2_Stream0_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_adc1);
   /* USER CODE BEGIN DMA2_Stream0_IRQn 1 */
+  TRACE_IRQ_EXIT();
 
   /* USER CODE END DMA2_Stream0_IRQn 1 */
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles DMA1 stream6 global interrupt (USART2_TX - logger).
+  */
+void DMA1_Stream6_IRQHandler(void)
+{
+  TRACE_IRQ_ENTER();
+  HAL_DMA_IRQHandler(&hdma_usart2_tx);
+  TRACE_IRQ_EXIT();
+}
+
+/**
+  * @brief This function handles USART2 global interrupt.
+  */
+void USART2_IRQHandler(void)
+{
+  TRACE_IRQ_ENTER();
+  HAL_UART_IRQHandler(&huart2);
+  TRACE_IRQ_EXIT();
+}
+
+/**
+  * @brief This function handles DMA1 stream7 global interrupt (I2C1_TX - LCD).
+  */
+void DMA1_Stream7_IRQHandler(void)
+{
+  TRACE_IRQ_ENTER();
+  HAL_DMA_IRQHandler(&hdma_i2c1_tx);
+  TRACE_IRQ_EXIT();
+}
+
+/**
+  * @brief This function handles I2C1 event interrupt.
+  */
+void I2C1_EV_IRQHandler(void)
+{
+  TRACE_IRQ_ENTER();
+  HAL_I2C_EV_IRQHandler(&hi2c1);
+  TRACE_IRQ_EXIT();
+}
+
+/**
+  * @brief This function handles I2C1 error interrupt.
+  */
+void I2C1_ER_IRQHandler(void)
+{
+  TRACE_IRQ_ENTER();
+  HAL_I2C_ER_IRQHandler(&hi2c1);
+  TRACE_IRQ_EXIT();
+}
+
+/**
+  * @brief This function handles EXTI line[15:10] interrupts (B1 user button).
+  */
+void EXTI15_10_IRQHandler(void)
+{
+  TRACE_IRQ_ENTER();
+  HAL_GPIO_EXTI_IRQHandler(B1_Pin);
+  TRACE_IRQ_EXIT();
+}
+
+/**
+  * @brief This function handles EXTI line[9:5] interrupts (nRF24 IRQ).
+  */
+void EXTI9_5_IRQHandler(void)
+{
+  TRACE_IRQ_ENTER();
+  HAL_GPIO_EXTI_IRQHandler(NRF24_IRQ_Pin);
+  TRACE_IRQ_EXIT();
+}
 
 /* USER CODE END 1 */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -30,6 +30,8 @@
 #include <time.h>
 #include <sys/time.h>
 #include <sys/times.h>
+#include "KK_LOGGER.h"
+#include "KK_TRACE.h"
 
 
 /* Variables */
@@ -80,12 +82,12 @@ return len;
 
 __attribute__((weak)) int _write(int file, char *ptr, int len)
 {
-	int DataIdx;
+	// With debugger tracing, stdout goes to ITM port 0 and keeps USART2 telemetry binary
+	if(TRACE_write(ptr, len))
+		return len;
 
-	for (DataIdx = 0; DataIdx < len; DataIdx++)
-	{
-		__io_putchar(*ptr++);
-	}
+	// stdout goes through logger ring buffer, text is dropped rather than blocking
+	LOGGER_write(ptr, len);
 	return len;
 }
 
@@ -89,6 +89,19 @@ LoopFillZerobss:
   cmp  r2, r3
   bcc  FillZerobss
 
+/* Paint heap, free RAM and stack with MEMSTAT_PAINT (KK_MEMSTAT.h) for high-water mark.
+   Stack is still empty here, whole fill takes a few ms at reset clock. */
+  ldr  r2, =_ebss
+  ldr  r1, =_estack
+  ldr  r3, =0xA5A5A5A5
+  b  LoopPaintRam
+PaintRam:
+  str  r3, [r2], #4
+
+LoopPaintRam:
+  cmp  r2, r1
+  bcc  PaintRam
+
 /* Call the clock system intitialization function.*/
   bl  SystemInit   
 /* Call static constructors */
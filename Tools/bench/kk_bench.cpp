@@ -0,0 +1,300 @@
+/*
+Program for:				Collecting and comparing on-target microbenchmark results
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Boat_TX/Inc/KK_BENCH.h
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:	kk_bench [options] <capture>
+
+		capture			USART2 output of a "Benchmark" build - tty, capture file or "-"
+						reading a tty stops after bench_end of every board that started
+		-b <baud>		tty baud rate (default 460800)
+		-w <file>		save results as baseline CSV
+		-c <file>		compare against baseline CSV
+		-t <percent>	allowed slowdown of mean cycles before it counts as regression (default 5)
+
+Exit status is 3 when comparison found a regression or a benchmark missing from the capture.
+*/
+
+#include "kk_input.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Options
+{
+	unsigned baudrate = kk::DEFAULT_BAUDRATE;
+	std::string writePath;
+	std::string comparePath;
+	double threshold = 5.0;
+	std::string input;
+};
+
+struct Result
+{
+	uint32_t iterations = 0;
+	uint32_t min = 0;
+	uint32_t mean = 0;
+	uint32_t max = 0;
+	uint32_t mhz = 0;
+	std::string skipped;
+};
+
+// Board and benchmark name
+using Key = std::pair<std::string, std::string>;
+
+void usage()
+{
+	std::fprintf(stderr, "usage: kk_bench [-b baud] [-w baseline.csv] [-c baseline.csv] [-t percent] <capture>\n");
+	std::exit(2);
+}
+
+Options parse(int argc, char **argv)
+{
+	Options opt;
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if((arg == "-b" || arg == "-w" || arg == "-c" || arg == "-t") && i + 1 >= argc)
+			usage();
+
+		if(arg == "-b")
+			opt.baudrate = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+		else if(arg == "-w")
+			opt.writePath = argv[++i];
+		else if(arg == "-c")
+			opt.comparePath = argv[++i];
+		else if(arg == "-t")
+			opt.threshold = std::strtod(argv[++i], nullptr);
+		else if(arg.size() > 1 && arg[0] == '-')
+			usage();
+		else if(opt.input.empty())
+			opt.input = arg;
+		else
+			usage();
+	}
+
+	if(opt.input.empty() || opt.threshold < 0)
+		usage();
+	return opt;
+}
+
+std::vector<std::string> split(const std::string &line)
+{
+	std::vector<std::string> fields;
+	std::stringstream stream(line);
+	std::string field;
+	while(std::getline(stream, field, ','))
+		fields.push_back(field);
+	return fields;
+}
+
+uint32_t toUint(const std::string &text)
+{
+	return static_cast<uint32_t>(std::strtoul(text.c_str(), nullptr, 10));
+}
+
+// Collects records from text lines - anything before "bench" (boot noise, telemetry frames) is ignored
+class Collector
+{
+public:
+	void line(std::string text)
+	{
+		size_t pos = text.find("bench");
+		while(pos != std::string::npos && pos + 5 < text.size() && text[pos + 5] != ',' && text[pos + 5] != '_')
+			pos = text.find("bench", pos + 1);
+		if(pos == std::string::npos)
+			return;
+
+		std::vector<std::string> f = split(text.substr(pos));
+		if(f.size() == 3 && f[0] == "bench_begin")
+		{
+			mhz_[f[1]] = toUint(f[2]);
+			running_.insert(f[1]);
+		}
+		else if(f.size() == 2 && f[0] == "bench_end")
+			running_.erase(f[1]);
+		else if(f.size() == 7 && f[0] == "bench")
+		{
+			Result &r = results[Key(f[1], f[2])];
+			r.iterations = toUint(f[3]);
+			r.min = toUint(f[4]);
+			r.mean = toUint(f[5]);
+			r.max = toUint(f[6]);
+			r.mhz = mhz_[f[1]];
+			r.skipped.clear();
+		}
+		else if(f.size() == 4 && f[0] == "bench_skip")
+			results[Key(f[1], f[2])].skipped = f[3];
+	}
+
+	// Every board that printed bench_begin also printed bench_end
+	bool finished() const { return !mhz_.empty() && running_.empty(); }
+
+	std::map<Key, Result> results;
+
+private:
+	std::map<std::string, uint32_t> mhz_;
+	std::set<std::string> running_;
+};
+
+bool readBaseline(const std::string &path, std::map<Key, Result> &baseline)
+{
+	std::ifstream file(path);
+	if(!file)
+		return false;
+
+	std::string line;
+	std::getline(file, line);
+	while(std::getline(file, line))
+	{
+		std::vector<std::string> f = split(line);
+		if(f.size() != 7)
+			continue;
+
+		Result &r = baseline[Key(f[0], f[1])];
+		r.iterations = toUint(f[2]);
+		r.min = toUint(f[3]);
+		r.mean = toUint(f[4]);
+		r.max = toUint(f[5]);
+		r.mhz = toUint(f[6]);
+	}
+	return true;
+}
+
+double microseconds(uint32_t cycles, uint32_t mhz)
+{
+	return mhz ? static_cast<double>(cycles) / mhz : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options opt = parse(argc, argv);
+
+	kk::Input input;
+	if(!input.open(opt.input, opt.baudrate))
+	{
+		std::fprintf(stderr, "kk_bench: %s\n", input.error().c_str());
+		return 1;
+	}
+
+	Collector collector;
+	std::string text;
+	uint8_t buffer[4096];
+	long n = 0;
+	while(!collector.finished() && (n = input.read(buffer, sizeof(buffer))) > 0)
+	{
+		for(long i = 0; i < n; i++)
+		{
+			char c = static_cast<char>(buffer[i]);
+			if(c == '\n' || c == '\0')
+			{
+				collector.line(text);
+				text.clear();
+			}
+			else if(c != '\r')
+				text += c;
+		}
+	}
+	collector.line(text);
+	if(n < 0)
+	{
+		std::fprintf(stderr, "kk_bench: %s\n", input.error().c_str());
+		return 1;
+	}
+
+	if(collector.results.empty())
+	{
+		std::fprintf(stderr, "kk_bench: no benchmark results in %s\n", opt.input.c_str());
+		return 1;
+	}
+
+	std::map<Key, Result> baseline;
+	if(!opt.comparePath.empty() && !readBaseline(opt.comparePath, baseline))
+	{
+		std::fprintf(stderr, "kk_bench: cannot read %s\n", opt.comparePath.c_str());
+		return 1;
+	}
+
+	std::printf("%-4s %-24s %6s %10s %10s %10s %10s", "", "benchmark", "iter", "min", "mean", "max", "mean us");
+	if(!baseline.empty())
+		std::printf(" %10s %8s", "baseline", "change");
+	std::printf("\n");
+
+	bool regression = false;
+	for(const auto &entry : collector.results)
+	{
+		const Key &key = entry.first;
+		const Result &r = entry.second;
+
+		std::printf("%-4s %-24s ", key.first.c_str(), key.second.c_str());
+		if(!r.skipped.empty())
+		{
+			std::printf("skipped (%s)\n", r.skipped.c_str());
+			continue;
+		}
+		std::printf("%6u %10u %10u %10u %10.2f", r.iterations, r.min, r.mean, r.max, microseconds(r.mean, r.mhz));
+
+		auto base = baseline.find(key);
+		if(base != baseline.end())
+		{
+			double change = base->second.mean ? 100.0 * (static_cast<double>(r.mean) - base->second.mean) / base->second.mean : 0.0;
+			bool slower = change > opt.threshold;
+			regression |= slower;
+			std::printf(" %10u %+7.1f%%%s", base->second.mean, change, slower ? "  REGRESSION" : "");
+		}
+		else if(!baseline.empty())
+			std::printf(" %10s", "new");
+		std::printf("\n");
+	}
+
+	// Benchmarks that disappeared hide regressions as well
+	for(const auto &entry : baseline)
+	{
+		auto result = collector.results.find(entry.first);
+		if(result == collector.results.end() || !result->second.skipped.empty())
+		{
+			std::printf("%-4s %-24s missing from capture\n", entry.first.first.c_str(), entry.first.second.c_str());
+			regression = true;
+		}
+	}
+
+	if(!opt.writePath.empty())
+	{
+		std::ofstream csv(opt.writePath);
+		if(!csv)
+		{
+			std::fprintf(stderr, "kk_bench: cannot write %s\n", opt.writePath.c_str());
+			return 1;
+		}
+		csv << "board,benchmark,iterations,min,mean,max,mhz\n";
+		for(const auto &entry : collector.results)
+		{
+			const Result &r = entry.second;
+			if(r.skipped.empty())
+				csv << entry.first.first << ',' << entry.first.second << ',' << r.iterations << ',' << r.min << ','
+					<< r.mean << ',' << r.max << ',' << r.mhz << '\n';
+		}
+	}
+
+	if(regression)
+	{
+		std::printf("regression against %s (threshold %.1f%%)\n", opt.comparePath.c_str(), opt.threshold);
+		return 3;
+	}
+	return 0;
+}
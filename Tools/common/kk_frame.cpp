@@ -0,0 +1,154 @@
+/*
+Library for:				Host decoder of KK_TELEMETRY frames
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Boat_TX/Inc/KK_TELEMETRY.h (frame layout, keep in sync)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#include "kk_frame.h"
+
+namespace kk {
+
+// CRC-16/CCITT-FALSE, same as firmware
+uint16_t crc16(const uint8_t *data, size_t len)
+{
+	uint16_t crc = 0xFFFF;
+
+	while(len--)
+	{
+		crc ^= static_cast<uint16_t>(*data++) << 8;
+		for(int i = 0; i < 8; i++)
+			crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+	}
+	return crc;
+}
+
+bool cobsDecode(const uint8_t *src, size_t len, std::vector<uint8_t> &dst)
+{
+	dst.clear();
+
+	size_t i = 0;
+	while(i < len)
+	{
+		uint8_t code = src[i++];
+		if(code == 0 || i + code - 1 > len)
+			return false;
+
+		for(uint8_t j = 1; j < code; j++)
+			dst.push_back(src[i++]);
+
+		// Implicit zero between blocks, not after the last one
+		if(code != 0xFF && i < len)
+			dst.push_back(0);
+	}
+	return true;
+}
+
+uint32_t get32(const uint8_t *src)
+{
+	return static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+		(static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+}
+
+const char *eventName(uint8_t event)
+{
+	switch(event)
+	{
+	case EVENT_BOOT:		return "boot";
+	case EVENT_LINK_LOST:	return "link_lost";
+	case EVENT_LINK_UP:		return "link_up";
+	case EVENT_LCD_MISSING:	return "lcd_missing";
+	case EVENT_CLOCK:		return "clock";
+	default:				return "unknown";
+	}
+}
+
+// Order of PROFILER_ZoneId
+const char *zoneName(uint8_t zone)
+{
+	static const char *const names[] = {
+		"loop", "nrf24_write_start", "nrf24_available", "nrf24_read", "display", "mixing", "telemetry",
+		"nrf24_write_finish",
+	};
+
+	return zone < sizeof(names) / sizeof(names[0]) ? names[zone] : "unknown";
+}
+
+size_t FrameDecoder::feed(const uint8_t *data, size_t len, std::vector<Frame> &out)
+{
+	size_t before = out.size();
+
+	bytes_ += len;
+	for(size_t i = 0; i < len; i++)
+	{
+		if(data[i] == 0)
+		{
+			finish(out);
+			continue;
+		}
+
+		// Garbage between frames (e.g. capture started mid-frame) is dropped at next delimiter
+		if(encoded_.size() < MAX_ENCODED)
+			encoded_.push_back(data[i]);
+		else
+			overflow_ = true;
+	}
+	return out.size() - before;
+}
+
+void FrameDecoder::finish(std::vector<Frame> &out)
+{
+	if(encoded_.empty())
+		return;
+
+	bool ok = !overflow_ && cobsDecode(encoded_.data(), encoded_.size(), raw_) && raw_.size() >= HEADER_SIZE + 2;
+	encoded_.clear();
+	overflow_ = false;
+
+	if(!ok)
+	{
+		framingErrors_++;
+		return;
+	}
+
+	size_t body = raw_.size() - 2;
+	uint16_t crc = static_cast<uint16_t>(raw_[body] | (raw_[body + 1] << 8));
+	if(crc != crc16(raw_.data(), body))
+	{
+		crcErrors_++;
+		return;
+	}
+
+	Frame frame;
+	frame.type = raw_[0];
+	frame.seq = raw_[1];
+	frame.timestamp = get32(&raw_[2]);
+	frame.payload.assign(raw_.begin() + HEADER_SIZE, raw_.begin() + body);
+	out.push_back(std::move(frame));
+	frames_++;
+}
+
+uint64_t Timeline::extend(uint32_t timestamp)
+{
+	if(!started_)
+	{
+		started_ = true;
+		newest_ = timestamp;
+		return newest_;
+	}
+
+	// Signed step from the newest stamp, forward across 2^32 is the wrap
+	int32_t step = static_cast<int32_t>(timestamp - static_cast<uint32_t>(newest_));
+	if(step >= 0)
+	{
+		newest_ += static_cast<uint32_t>(step);
+		return newest_;
+	}
+
+	reordered_++;
+	uint64_t back = static_cast<uint64_t>(-static_cast<int64_t>(step));
+	return back < newest_ ? newest_ - back : 0;
+}
+
+} // namespace kk
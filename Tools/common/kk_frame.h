@@ -0,0 +1,110 @@
+/*
+Library for:				Host decoder of KK_TELEMETRY frames
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Boat_TX/Inc/KK_TELEMETRY.h (frame layout, keep in sync)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#ifndef KK_FRAME_H
+#define KK_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kk {
+
+// Mirrors KK_TELEMETRY.h
+constexpr uint8_t SOURCE_TX = 0x01;
+constexpr uint8_t SOURCE_RX = 0x02;
+
+constexpr uint8_t TYPE_CONTROL = 0x01;
+constexpr uint8_t TYPE_LINK = 0x02;
+constexpr uint8_t TYPE_LOOP = 0x03;
+constexpr uint8_t TYPE_EVENT = 0x04;
+constexpr uint8_t TYPE_PROFILE = 0x05;
+constexpr uint8_t TYPE_MEMORY = 0x06;
+constexpr uint8_t TYPE_STACK = 0x07;
+
+constexpr uint8_t CONTROL_ACKED = 0x01;
+
+constexpr uint8_t EVENT_BOOT = 0x01;
+constexpr uint8_t EVENT_LINK_LOST = 0x02;
+constexpr uint8_t EVENT_LINK_UP = 0x03;
+constexpr uint8_t EVENT_LCD_MISSING = 0x04;
+constexpr uint8_t EVENT_CLOCK = 0x05;
+
+// Mirrors KK_PROFILER.h
+constexpr size_t PROFILE_SIZE = 50;
+constexpr size_t PROFILE_BUCKETS = 16;
+constexpr unsigned PROFILE_BUCKET_SHIFT = 8;
+
+// Mirrors KK_MEMSTAT.h
+constexpr size_t MEMORY_SIZE = 24;
+constexpr size_t STACK_SIZE = 21;
+constexpr size_t STACK_NAME = 12;
+
+constexpr size_t HEADER_SIZE = 6;
+constexpr size_t MAX_ENCODED = 80;
+
+struct Frame
+{
+	uint8_t type;
+	uint8_t seq;
+	uint32_t timestamp;					// microseconds, wraps every 2^32
+	std::vector<uint8_t> payload;
+};
+
+uint16_t crc16(const uint8_t *data, size_t len);
+// Returns false on malformed input
+bool cobsDecode(const uint8_t *src, size_t len, std::vector<uint8_t> &dst);
+uint32_t get32(const uint8_t *src);
+const char *eventName(uint8_t event);
+const char *zoneName(uint8_t zone);
+
+// Splits a byte stream on 0x00 and yields valid frames
+class FrameDecoder
+{
+public:
+	// Returns number of frames appended to out
+	size_t feed(const uint8_t *data, size_t len, std::vector<Frame> &out);
+
+	uint64_t bytes() const { return bytes_; }
+	uint64_t frames() const { return frames_; }
+	uint64_t crcErrors() const { return crcErrors_; }
+	uint64_t framingErrors() const { return framingErrors_; }
+
+private:
+	void finish(std::vector<Frame> &out);
+
+	std::vector<uint8_t> encoded_;
+	std::vector<uint8_t> raw_;
+	bool overflow_ = false;
+	uint64_t bytes_ = 0;
+	uint64_t frames_ = 0;
+	uint64_t crcErrors_ = 0;
+	uint64_t framingErrors_ = 0;
+};
+
+// Extends wrapping 32-bit timestamps to 64 bits. A stamp up to 2^31 behind the newest one is
+// reordering (a task stamped its frame, got preempted, wrote it late) and extends below the
+// newest, a larger step back is a wrap
+class Timeline
+{
+public:
+	uint64_t extend(uint32_t timestamp);
+	void reset() { started_ = false; }
+
+	// Stamps older than the newest one seen before them
+	uint64_t reordered() const { return reordered_; }
+
+private:
+	bool started_ = false;
+	uint64_t newest_ = 0;
+	uint64_t reordered_ = 0;
+};
+
+} // namespace kk
+
+#endif
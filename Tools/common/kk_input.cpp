@@ -0,0 +1,106 @@
+/*
+Library for:				Host byte sources - serial port, pty or capture file
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- termios(3)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#include "kk_input.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace kk {
+
+static speed_t toSpeed(unsigned baudrate)
+{
+	switch(baudrate)
+	{
+	case 9600:		return B9600;
+	case 19200:		return B19200;
+	case 38400:		return B38400;
+	case 57600:		return B57600;
+	case 115200:	return B115200;
+	case 230400:	return B230400;
+	case 460800:	return B460800;
+	case 921600:	return B921600;
+	case 1000000:	return B1000000;
+	case 2000000:	return B2000000;
+	default:		return B0;
+	}
+}
+
+Input::~Input()
+{
+	if(owned_ && fd_ >= 0)
+		::close(fd_);
+}
+
+bool Input::open(const std::string &path, unsigned baudrate)
+{
+	if(path == "-")
+	{
+		fd_ = STDIN_FILENO;
+		live_ = isatty(fd_);
+		return true;
+	}
+
+	fd_ = ::open(path.c_str(), O_RDONLY | O_NOCTTY);
+	if(fd_ < 0)
+	{
+		error_ = path + ": " + std::strerror(errno);
+		return false;
+	}
+	owned_ = true;
+
+	if(!isatty(fd_))
+		return true;
+
+	live_ = true;
+	speed_t speed = toSpeed(baudrate);
+	if(speed == B0)
+	{
+		error_ = "unsupported baud rate " + std::to_string(baudrate);
+		return false;
+	}
+
+	// A pty ignores the speed, a real USB-UART bridge needs it
+	termios tio{};
+	if(tcgetattr(fd_, &tio) != 0)
+	{
+		error_ = path + ": " + std::strerror(errno);
+		return false;
+	}
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN] = 1;
+	tio.c_cc[VTIME] = 0;
+	if(tcsetattr(fd_, TCSANOW, &tio) != 0)
+	{
+		error_ = path + ": " + std::strerror(errno);
+		return false;
+	}
+	tcflush(fd_, TCIFLUSH);
+	return true;
+}
+
+long Input::read(uint8_t *buffer, size_t len)
+{
+	ssize_t n = ::read(fd_, buffer, len);
+	if(n >= 0)
+		return static_cast<long>(n);
+
+	// Interrupted by Ctrl+C, or pty master closed - both end the capture
+	if(errno == EINTR || (errno == EIO && live_))
+		return 0;
+	error_ = std::strerror(errno);
+	return -1;
+}
+
+} // namespace kk
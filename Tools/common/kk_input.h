@@ -0,0 +1,45 @@
+/*
+Library for:				Host byte sources - serial port, pty or capture file
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- termios(3)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#ifndef KK_INPUT_H
+#define KK_INPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace kk {
+
+// Default rate of KK_LOGGER (LOGGER_BAUDRATE)
+constexpr unsigned DEFAULT_BAUDRATE = 460800;
+
+class Input
+{
+public:
+	Input() = default;
+	~Input();
+	Input(const Input &) = delete;
+	Input &operator=(const Input &) = delete;
+
+	// "-" is stdin, tty devices are switched to raw mode at given baud rate
+	bool open(const std::string &path, unsigned baudrate = DEFAULT_BAUDRATE);
+	// Blocks until data; returns 0 at end of file or on signal, -1 on error
+	long read(uint8_t *buffer, size_t len);
+	bool isLive() const { return live_; }
+	const std::string &error() const { return error_; }
+
+private:
+	int fd_ = -1;
+	bool live_ = false;
+	bool owned_ = false;
+	std::string error_;
+};
+
+} // namespace kk
+
+#endif
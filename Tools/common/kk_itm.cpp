@@ -0,0 +1,187 @@
+/*
+Library for:				Host decoder of ITM packets and KK_TRACE events from SWO captures
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- ARMv7-M Architecture Reference Manual, Appendix D4 Debug ITM and DWT Packet Protocol
+							- Boat_TX/Inc/KK_TRACE.h (event layout, keep in sync)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#include "kk_itm.h"
+
+namespace kk {
+
+const char *traceName(uint8_t event)
+{
+	switch(event)
+	{
+	case TRACE_SYNC:			return "sync";
+	case TRACE_IRQ_ENTER:		return "irq_enter";
+	case TRACE_IRQ_EXIT:		return "irq_exit";
+	case TRACE_TASK_START:		return "task_start";
+	case TRACE_TASK_STOP:		return "task_stop";
+	case TRACE_RADIO_TX:		return "radio_tx";
+	case TRACE_RADIO_TX_DONE:	return "radio_tx_done";
+	case TRACE_RADIO_RX:		return "radio_rx";
+	case TRACE_FAILSAFE_ENTER:	return "failsafe_enter";
+	case TRACE_FAILSAFE_EXIT:	return "failsafe_exit";
+	case TRACE_SPI_BEGIN:		return "spi_begin";
+	case TRACE_SPI_END:			return "spi_end";
+	case TRACE_I2C_BEGIN:		return "i2c_begin";
+	case TRACE_I2C_END:			return "i2c_end";
+	case TRACE_CLOCK:			return "clock";
+	default:					return "unknown";
+	}
+}
+
+// Only handlers used by the boards, exception number = IRQn + 16
+const char *irqName(uint32_t exception)
+{
+	switch(exception)
+	{
+	case 15:	return "SysTick";
+	case 33:	return "DMA1_Stream6";
+	case 39:	return "EXTI9_5";
+	case 47:	return "I2C1_EV";
+	case 48:	return "I2C1_ER";
+	case 54:	return "USART2";
+	case 56:	return "EXTI15_10";
+	case 63:	return "DMA1_Stream7";
+	case 72:	return "DMA2_Stream0";
+	default:	return "irq";
+	}
+}
+
+size_t ItmDecoder::feed(const uint8_t *data, size_t len, std::vector<ItmPacket> &out)
+{
+	size_t before = out.size();
+
+	for(size_t i = 0; i < len; i++)
+	{
+		uint8_t b = data[i];
+
+		switch(state_)
+		{
+		case State::Payload:
+			packet_.value |= static_cast<uint32_t>(b) << (8 * received_);
+			if(++received_ == packet_.size)
+			{
+				if(software_)
+					out.push_back(packet_);
+				else
+					skipped_++;
+				state_ = State::Header;
+			}
+			continue;
+
+		case State::Continuation:
+			if(!(b & 0x80))
+				state_ = State::Header;
+			continue;
+
+		case State::Header:
+			break;
+		}
+
+		// Synchronisation - at least 47 zero bits followed by a one
+		if(b == 0x00)
+		{
+			zeros_++;
+			continue;
+		}
+		if(b == 0x80 && zeros_ >= 5)
+		{
+			zeros_ = 0;
+			syncs_++;
+			continue;
+		}
+		zeros_ = 0;
+
+		if(b == 0x70)
+		{
+			overflows_++;
+		}
+		else if((b & 0x03) != 0)
+		{
+			// Source packet, bit 2 selects hardware (DWT) source
+			static const uint8_t sizes[] = { 0, 1, 2, 4 };
+			packet_.port = b >> 3;
+			packet_.size = sizes[b & 0x03];
+			packet_.value = 0;
+			received_ = 0;
+			software_ = !(b & 0x04);
+			state_ = State::Payload;
+		}
+		else if((b & 0x0F) == 0x00)
+		{
+			// Local timestamp - format 1 has continuation bytes, format 2 is single byte
+			skipped_++;
+			if(b & 0x80)
+				state_ = State::Continuation;
+		}
+		else if(b == 0x94 || b == 0xB4 || (b & 0x0B) == 0x08)
+		{
+			// Global timestamp or extension
+			skipped_++;
+			if(b & 0x80)
+				state_ = State::Continuation;
+		}
+		else
+		{
+			skipped_++;
+		}
+	}
+	return out.size() - before;
+}
+
+size_t TraceDecoder::feed(const std::vector<ItmPacket> &packets, std::vector<TraceEvent> &out)
+{
+	size_t before = out.size();
+
+	for(const ItmPacket &p : packets)
+	{
+		if(p.size != 4)
+			continue;
+
+		if(p.port == TRACE_PORT_TIME)
+		{
+			if(haveTime_)
+				unpaired_++;
+			haveTime_ = true;
+			time_ = p.value;
+		}
+		else if(p.port == TRACE_PORT_EVENT)
+		{
+			if(!haveTime_)
+			{
+				unpaired_++;
+				continue;
+			}
+			haveTime_ = false;
+
+			TraceEvent e;
+			e.event = static_cast<uint8_t>(p.value >> 24);
+			e.arg = p.value & 0x00FFFFFF;
+			// New session restarts the cycle counter base and clock
+			if(e.event == TRACE_SYNC)
+			{
+				timeline_.reset();
+				lastCycles_ = 0;
+				us_ = 0;
+				mhz_ = bootMhz_;
+			}
+			e.cycles = timeline_.extend(time_);
+
+			// Cycles count at the rate set by the last CLOCK event, a reordered stamp steps back
+			us_ += (static_cast<double>(e.cycles) - static_cast<double>(lastCycles_)) / mhz_;
+			lastCycles_ = e.cycles;
+			e.us = us_;
+			if(e.event == TRACE_CLOCK && e.arg)
+				mhz_ = e.arg;
+			out.push_back(e);
+		}
+	}
+	return out.size() - before;
+}
+
+} // namespace kk
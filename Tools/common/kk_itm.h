@@ -0,0 +1,108 @@
+/*
+Library for:				Host decoder of ITM packets and KK_TRACE events from SWO captures
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- ARMv7-M Architecture Reference Manual, Appendix D4 Debug ITM and DWT Packet Protocol
+							- Boat_TX/Inc/KK_TRACE.h (event layout, keep in sync)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#ifndef KK_ITM_H
+#define KK_ITM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "kk_frame.h"
+
+namespace kk {
+
+// Mirrors KK_TRACE.h
+constexpr uint8_t TRACE_PORT_TEXT = 0;
+constexpr uint8_t TRACE_PORT_TIME = 1;
+constexpr uint8_t TRACE_PORT_EVENT = 2;
+
+constexpr uint8_t TRACE_SYNC = 0x01;
+constexpr uint8_t TRACE_IRQ_ENTER = 0x02;
+constexpr uint8_t TRACE_IRQ_EXIT = 0x03;
+constexpr uint8_t TRACE_TASK_START = 0x04;
+constexpr uint8_t TRACE_TASK_STOP = 0x05;
+constexpr uint8_t TRACE_RADIO_TX = 0x06;
+constexpr uint8_t TRACE_RADIO_TX_DONE = 0x07;
+constexpr uint8_t TRACE_RADIO_RX = 0x08;
+constexpr uint8_t TRACE_FAILSAFE_ENTER = 0x09;
+constexpr uint8_t TRACE_FAILSAFE_EXIT = 0x0A;
+constexpr uint8_t TRACE_SPI_BEGIN = 0x0B;
+constexpr uint8_t TRACE_SPI_END = 0x0C;
+constexpr uint8_t TRACE_I2C_BEGIN = 0x0D;
+constexpr uint8_t TRACE_I2C_END = 0x0E;
+constexpr uint8_t TRACE_CLOCK = 0x0F;
+
+const char *traceName(uint8_t event);
+// Cortex-M exception number to STM32F446 handler name
+const char *irqName(uint32_t exception);
+
+// Software source packet (stimulus port write)
+struct ItmPacket
+{
+	uint8_t port;
+	uint8_t size;
+	uint32_t value;
+};
+
+// Byte stream (NRZ SWO, TPIU formatter off) to stimulus packets
+class ItmDecoder
+{
+public:
+	size_t feed(const uint8_t *data, size_t len, std::vector<ItmPacket> &out);
+
+	uint64_t syncs() const { return syncs_; }
+	uint64_t overflows() const { return overflows_; }
+	uint64_t skipped() const { return skipped_; }
+
+private:
+	enum class State { Header, Payload, Continuation };
+
+	State state_ = State::Header;
+	unsigned zeros_ = 0;
+	ItmPacket packet_{};
+	uint8_t received_ = 0;
+	bool software_ = false;
+	uint64_t syncs_ = 0;
+	uint64_t overflows_ = 0;
+	uint64_t skipped_ = 0;
+};
+
+struct TraceEvent
+{
+	uint64_t cycles;					// DWT->CYCCNT extended to 64 bits
+	double us;							// since SYNC, follows CLOCK events
+	uint8_t event;
+	uint32_t arg;
+};
+
+// Pairs time and event stimulus writes, mhz is the core clock at SYNC
+class TraceDecoder
+{
+public:
+	explicit TraceDecoder(double mhz = 84.0) : bootMhz_(mhz), mhz_(mhz) {}
+
+	size_t feed(const std::vector<ItmPacket> &packets, std::vector<TraceEvent> &out);
+
+	uint64_t unpaired() const { return unpaired_; }
+
+private:
+	Timeline timeline_;
+	bool haveTime_ = false;
+	uint32_t time_ = 0;
+	uint64_t unpaired_ = 0;
+	double bootMhz_;
+	double mhz_;
+	uint64_t lastCycles_ = 0;
+	double us_ = 0;
+};
+
+} // namespace kk
+
+#endif
@@ -0,0 +1,222 @@
+/*
+Library for:				Host parser of GNU ld map files
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- GNU ld --Map output ("Memory Configuration", "Linker script and memory map")
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#include "kk_map.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace kk {
+
+static bool isHex(const std::string &word)
+{
+	return word.size() > 2 && word[0] == '0' && word[1] == 'x';
+}
+
+static uint64_t hex(const std::string &word)
+{
+	return std::strtoull(word.c_str(), nullptr, 16);
+}
+
+static std::vector<std::string> words(const std::string &line)
+{
+	std::vector<std::string> out;
+	std::istringstream stream(line);
+	std::string word;
+	while(stream >> word)
+		out.push_back(word);
+	return out;
+}
+
+// Rest of line after n whitespace separated words - object paths may contain spaces
+static std::string after(const std::string &line, size_t n)
+{
+	size_t pos = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		pos = line.find_first_not_of(" \t", pos);
+		pos = line.find_first_of(" \t", pos);
+		if(pos == std::string::npos)
+			return "";
+	}
+	pos = line.find_first_not_of(" \t", pos);
+	if(pos == std::string::npos)
+		return "";
+
+	std::string rest = line.substr(pos);
+	while(!rest.empty() && (rest.back() == ' ' || rest.back() == '\r'))
+		rest.pop_back();
+	return rest;
+}
+
+std::string objectName(const std::string &file)
+{
+	size_t open = file.rfind('(');
+	if(open != std::string::npos && !file.empty() && file.back() == ')')
+		return file.substr(open + 1, file.size() - open - 2);
+
+	size_t slash = file.find_last_of("/\\");
+	return slash == std::string::npos ? file : file.substr(slash + 1);
+}
+
+std::string archiveName(const std::string &file)
+{
+	size_t open = file.rfind('(');
+	if(open == std::string::npos || file.empty() || file.back() != ')')
+		return "";
+
+	std::string archive = file.substr(0, open);
+	size_t slash = archive.find_last_of("/\\");
+	return slash == std::string::npos ? archive : archive.substr(slash + 1);
+}
+
+void MapFile::input(const std::string &name, uint64_t address, uint64_t size, const std::string &file)
+{
+	if(outputs_.empty())
+		return;
+	inputs_.push_back(MapInput{outputs_.size() - 1, name, address, size, file});
+}
+
+bool MapFile::load(const std::string &path)
+{
+	std::ifstream file(path);
+	if(!file)
+	{
+		error_ = "cannot read " + path;
+		return false;
+	}
+
+	regions_.clear();
+	outputs_.clear();
+	inputs_.clear();
+	symbols_.clear();
+
+	enum { START, MEMORY, MAP } part = START;
+	bool skipOutput = true;				// non-allocated sections (debug info) are not placed anywhere
+	std::string pendingOutput;
+	std::string pendingInput;
+	std::string line;
+
+	while(std::getline(file, line))
+	{
+		if(!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		if(line.rfind("Memory Configuration", 0) == 0)
+		{
+			part = MEMORY;
+			continue;
+		}
+		if(line.rfind("Linker script and memory map", 0) == 0)
+		{
+			part = MAP;
+			continue;
+		}
+
+		std::vector<std::string> w = words(line);
+		if(part == MEMORY)
+		{
+			if(w.size() >= 3 && w[0] != "Name" && isHex(w[1]) && isHex(w[2]) && w[0] != "*default*")
+				regions_.push_back(MapRegion{w[0], hex(w[1]), hex(w[2])});
+			continue;
+		}
+		if(part != MAP || w.empty())
+			continue;
+
+		// Output section header, name alone on the line when it is long
+		if(line[0] == '.' || !pendingOutput.empty())
+		{
+			std::string name = pendingOutput.empty() ? w[0] : pendingOutput;
+			size_t first = pendingOutput.empty() ? 1 : 0;
+			pendingOutput.clear();
+			pendingInput.clear();
+
+			if(w.size() < first + 2 || !isHex(w[first]) || !isHex(w[first + 1]))
+			{
+				if(w.size() == 1 && line[0] == '.')
+					pendingOutput = name;
+				else
+					skipOutput = true;
+				continue;
+			}
+
+			uint64_t address = hex(w[first]);
+			skipOutput = address == 0;
+			if(!skipOutput)
+				outputs_.push_back(MapOutput{name, address, hex(w[first + 1]),
+					line.find("load address") != std::string::npos});
+			continue;
+		}
+
+		// /DISCARD/ and other non-section lines end the previous output section
+		if(line[0] != ' ')
+		{
+			skipOutput = true;
+			continue;
+		}
+		if(skipOutput)
+			continue;
+
+		// Input section - " name addr size file", or " name" with the rest on next line
+		if(line.size() > 1 && line[1] != ' ')
+		{
+			pendingInput.clear();
+			if(w[0][0] == '*' && w[0] != "*fill*")
+				continue;					// input section pattern like *(.text*)
+
+			if(w.size() == 1)
+			{
+				pendingInput = w[0];
+				continue;
+			}
+			if(w.size() >= 3 && isHex(w[1]) && isHex(w[2]))
+				input(w[0], hex(w[1]), hex(w[2]), after(line, 3));
+			continue;
+		}
+
+		// Continuation of long input section name
+		if(!pendingInput.empty())
+		{
+			if(w.size() >= 2 && isHex(w[0]) && isHex(w[1]))
+				input(pendingInput, hex(w[0]), hex(w[1]), after(line, 2));
+			pendingInput.clear();
+			continue;
+		}
+
+		// Symbol inside last input section - "addr name", assignments contain '='
+		if(w.size() == 2 && isHex(w[0]) && !inputs_.empty() && line.find('=') == std::string::npos
+			&& inputs_.back().output == outputs_.size() - 1)
+			symbols_.push_back(MapSymbol{w[1], hex(w[0]), inputs_.size() - 1});
+	}
+
+	if(outputs_.empty())
+	{
+		error_ = path + ": no memory map found";
+		return false;
+	}
+	return true;
+}
+
+const MapRegion *MapFile::regionOf(uint64_t address) const
+{
+	for(const MapRegion &r : regions_)
+		if(address >= r.origin && address < r.origin + r.length)
+			return &r;
+	return nullptr;
+}
+
+const MapSymbol *MapFile::findSymbol(const std::string &name) const
+{
+	for(const MapSymbol &s : symbols_)
+		if(s.name == name)
+			return &s;
+	return nullptr;
+}
+
+} // namespace kk
@@ -0,0 +1,84 @@
+/*
+Library for:				Host parser of GNU ld map files
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- GNU ld --Map output ("Memory Configuration", "Linker script and memory map")
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#ifndef KK_MAP_H
+#define KK_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace kk {
+
+struct MapRegion
+{
+	std::string name;					// FLASH, RAM, ...
+	uint64_t origin;
+	uint64_t length;
+};
+
+// Allocated output section, e.g. .text or .data
+struct MapOutput
+{
+	std::string name;
+	uint64_t address;
+	uint64_t size;
+	bool loaded;						// has separate load address - copied from flash at startup
+};
+
+// One input section placed into an output section
+struct MapInput
+{
+	size_t output;						// index into MapFile::outputs()
+	std::string name;					// .text.NRF24_write, COMMON, *fill*, ...
+	uint64_t address;
+	uint64_t size;
+	std::string file;					// object path, archive(member) or empty for fill
+};
+
+struct MapSymbol
+{
+	std::string name;
+	uint64_t address;
+	size_t input;						// index into MapFile::inputs()
+};
+
+class MapFile
+{
+public:
+	bool load(const std::string &path);
+	const std::string &error() const { return error_; }
+
+	const std::vector<MapRegion> &regions() const { return regions_; }
+	const std::vector<MapOutput> &outputs() const { return outputs_; }
+	const std::vector<MapInput> &inputs() const { return inputs_; }
+	const std::vector<MapSymbol> &symbols() const { return symbols_; }
+
+	// Region containing address or nullptr
+	const MapRegion *regionOf(uint64_t address) const;
+	const MapSymbol *findSymbol(const std::string &name) const;
+
+private:
+	void input(const std::string &name, uint64_t address, uint64_t size, const std::string &file);
+
+	std::vector<MapRegion> regions_;
+	std::vector<MapOutput> outputs_;
+	std::vector<MapInput> inputs_;
+	std::vector<MapSymbol> symbols_;
+	std::string error_;
+};
+
+// Archive member or object file name without directories: "libgcc.a(_arm_addsubdf3.o)" -> "_arm_addsubdf3.o"
+std::string objectName(const std::string &file);
+// Archive file name without directories or empty: "...\hard\libc_nano.a(lib_a-strlen.o)" -> "libc_nano.a"
+std::string archiveName(const std::string &file);
+
+} // namespace kk
+
+#endif
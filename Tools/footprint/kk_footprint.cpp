@@ -0,0 +1,441 @@
+/*
+Program for:				Flash / RAM footprint per module from linker map files
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- GNU ld map file of STM32CubeIDE builds (Debug/Boat_TX.map, Debug/Boat_RX.map)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:	kk_footprint [options] <map>...
+
+		map				linker map, board name is the file name without extension
+		-c <file>		compare against budget CSV (board,module,flash,ram)
+		-w <file>		write current footprint as budget CSV
+		-m <percent>	headroom added to budgets written with -w (default 10)
+		-r <file>		check that code listed in CSV (board,function or board,object.o) runs from RAM
+		-v				list object files of every module
+
+Flash counts .text, .rodata and the load image of .data, RAM counts .data and .bss. Heap and
+stack reservations of the linker script are reported separately. Exit status is 3 when a module
+is over budget or has no budget, or listed RAM code is missing or placed in flash. A new module
+fails until it gets a budget - write one with -w from maps of a build of the current tree and
+review the new rows before committing them. Static functions have no symbol in the map, list their
+object file instead - all its .RamFunc input sections then have to be in RAM.
+
+e.g.	kk_footprint -c Tools/footprint/budget.csv -r Tools/footprint/ramfunc.csv Boat_TX/Debug/Boat_TX.map
+*/
+
+#include "kk_map.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Options
+{
+	std::string comparePath;
+	std::string writePath;
+	std::string ramPath;
+	double margin = 10.0;
+	bool verbose = false;
+	std::vector<std::string> maps;
+};
+
+struct Size
+{
+	uint64_t text = 0;
+	uint64_t rodata = 0;
+	uint64_t data = 0;
+	uint64_t bss = 0;
+
+	uint64_t flash() const { return text + rodata + data; }
+	uint64_t ram() const { return data + bss; }
+
+	void add(const Size &other)
+	{
+		text += other.text;
+		rodata += other.rodata;
+		data += other.data;
+		bss += other.bss;
+	}
+};
+
+struct Budget
+{
+	uint64_t flash = 0;
+	uint64_t ram = 0;
+};
+
+// Board and module
+using Key = std::pair<std::string, std::string>;
+
+void usage()
+{
+	std::fprintf(stderr, "usage: kk_footprint [-c budget.csv] [-w budget.csv] [-m percent] [-r ramfunc.csv] [-v] <map>...\n");
+	std::exit(2);
+}
+
+Options parse(int argc, char **argv)
+{
+	Options opt;
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if((arg == "-c" || arg == "-w" || arg == "-m" || arg == "-r") && i + 1 >= argc)
+			usage();
+
+		if(arg == "-c")
+			opt.comparePath = argv[++i];
+		else if(arg == "-w")
+			opt.writePath = argv[++i];
+		else if(arg == "-r")
+			opt.ramPath = argv[++i];
+		else if(arg == "-m")
+			opt.margin = std::strtod(argv[++i], nullptr);
+		else if(arg == "-v")
+			opt.verbose = true;
+		else if(arg.size() > 1 && arg[0] == '-')
+			usage();
+		else
+			opt.maps.push_back(arg);
+	}
+
+	if(opt.maps.empty() || opt.margin < 0)
+		usage();
+	return opt;
+}
+
+std::string lower(std::string text)
+{
+	for(char &c : text)
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	return text;
+}
+
+bool contains(const std::string &text, const char *part)
+{
+	return text.find(part) != std::string::npos;
+}
+
+std::string boardName(const std::string &path)
+{
+	size_t slash = path.find_last_of("/\\");
+	std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+	size_t dot = name.rfind('.');
+	return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+// Module of an input section - our drivers by file, libraries by archive member
+std::string moduleOf(const kk::MapInput &in)
+{
+	if(in.file.empty() || in.name == "*fill*")
+		return "fill";
+	if(in.file == "linker stubs")
+		return "crt";
+
+	std::string archive = kk::archiveName(in.file);
+	std::string object = kk::objectName(in.file);
+
+	if(!archive.empty())
+	{
+		if(archive == "libgcc.a")
+			return (object.rfind("_arm_", 0) == 0 && (contains(object, "df") || contains(object, "sf"))) ? "softfloat" : "libgcc";
+		if(archive == "libm.a")
+			return "libm";
+		if(archive.rfind("libc", 0) == 0 || archive == "libnosys.a")
+		{
+			if(contains(object, "printf"))
+				return "libc_printf";
+			if(contains(object, "malloc") || contains(object, "free") || contains(object, "sbrk") || contains(object, "mlock")
+				|| contains(object, "msize"))
+				return "libc_malloc";
+			return "libc";
+		}
+		return archive.substr(0, archive.rfind('.'));
+	}
+
+	if(object.rfind("crt", 0) == 0)
+		return "crt";
+	if(contains(in.file, "STM32F4xx_HAL_Driver"))
+		return "hal";
+	if(contains(in.file, "CMSIS"))
+		return "cmsis";
+	if(contains(in.file, "Startup"))
+		return "startup";
+
+	std::string stem = object.substr(0, object.rfind('.'));
+	if(stem == "NRF24")
+		return "nrf24";
+	if(stem == "KK_LCD1602A" || stem == "KK_DISPLAY")
+		return "lcd";
+	if(stem.rfind("KK_", 0) == 0)
+		return lower(stem.substr(3));
+	if(stem == "main")
+		return "app";
+	return "cube";
+}
+
+// Which part of the image the input section belongs to
+void account(const kk::MapFile &map, const kk::MapInput &in, Size &size)
+{
+	const kk::MapOutput &out = map.outputs()[in.output];
+	const kk::MapRegion *region = map.regionOf(out.address);
+	bool flash = region && contains(region->name, "FLASH");
+
+	// ld prints a load address for .bss as well, zero-initialised input is recognised by name
+	if(!flash && (out.name.rfind(".bss", 0) == 0 || in.name.rfind(".bss", 0) == 0 || in.name == "COMMON" || !out.loaded))
+		size.bss += in.size;
+	else if(out.loaded)
+		size.data += in.size;
+	else if(out.name == ".text" || out.name == ".isr_vector")
+		size.text += in.size;
+	else
+		size.rodata += in.size;
+}
+
+// Rows of a CSV file with header line
+bool readCsv(const std::string &path, std::vector<std::vector<std::string>> &rows)
+{
+	std::ifstream file(path);
+	if(!file)
+		return false;
+
+	std::string line;
+	std::getline(file, line);
+	while(std::getline(file, line))
+	{
+		if(!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		std::vector<std::string> f;
+		std::stringstream stream(line);
+		std::string field;
+		while(std::getline(stream, field, ','))
+			f.push_back(field);
+		if(!f.empty())
+			rows.push_back(f);
+	}
+	return true;
+}
+
+bool readBudget(const std::string &path, std::map<Key, Budget> &budget)
+{
+	std::vector<std::vector<std::string>> rows;
+	if(!readCsv(path, rows))
+		return false;
+
+	for(const auto &f : rows)
+		if(f.size() == 4)
+			budget[Key(f[0], f[1])] = Budget{std::strtoull(f[2].c_str(), nullptr, 10), std::strtoull(f[3].c_str(), nullptr, 10)};
+	return true;
+}
+
+bool inRam(const kk::MapFile &map, uint64_t address)
+{
+	const kk::MapRegion *region = map.regionOf(address);
+	return region && contains(region->name, "RAM");
+}
+
+// Listed functions (or .RamFunc sections of listed objects) must be placed in RAM, returns false if not
+bool checkRam(const kk::MapFile &map, const std::string &board, const std::vector<std::vector<std::string>> &list)
+{
+	bool ok = true;
+
+	for(const auto &f : list)
+	{
+		if(f.size() != 2 || f[0] != board)
+			continue;
+
+		const std::string &name = f[1];
+		if(name.size() > 2 && name.compare(name.size() - 2, 2, ".o") == 0)
+		{
+			uint64_t bytes = 0;
+			bool placed = true;
+			for(const kk::MapInput &in : map.inputs())
+			{
+				if(in.name.rfind(".RamFunc", 0) != 0 || kk::objectName(in.file) != name)
+					continue;
+				bytes += in.size;
+				placed &= inRam(map, in.address);
+			}
+
+			placed &= bytes > 0;
+			ok &= placed;
+			std::printf("ram code %-24s %6llu bytes %s\n", name.c_str(), (unsigned long long)bytes,
+				!bytes ? "MISSING" : placed ? "in RAM" : "IN FLASH");
+			continue;
+		}
+
+		const kk::MapSymbol *symbol = map.findSymbol(name);
+		bool placed = symbol && inRam(map, symbol->address);
+		ok &= placed;
+		if(symbol)
+			std::printf("ram code %-24s 0x%08llx %s\n", name.c_str(), (unsigned long long)symbol->address,
+				placed ? "in RAM" : "IN FLASH");
+		else
+			std::printf("ram code %-24s MISSING\n", name.c_str());
+	}
+	return ok;
+}
+
+// Budget with headroom, rounded up to 16 bytes so small modules get some slack too
+uint64_t withMargin(uint64_t bytes, double margin)
+{
+	uint64_t value = static_cast<uint64_t>(bytes * (1.0 + margin / 100.0) + 0.999);
+	return (value + 15) / 16 * 16;
+}
+
+double kib(uint64_t bytes)
+{
+	return bytes / 1024.0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options opt = parse(argc, argv);
+
+	std::map<Key, Budget> budget;
+	if(!opt.comparePath.empty() && !readBudget(opt.comparePath, budget))
+	{
+		std::fprintf(stderr, "kk_footprint: cannot read %s\n", opt.comparePath.c_str());
+		return 1;
+	}
+
+	std::vector<std::vector<std::string>> ramList;
+	if(!opt.ramPath.empty() && !readCsv(opt.ramPath, ramList))
+	{
+		std::fprintf(stderr, "kk_footprint: cannot read %s\n", opt.ramPath.c_str());
+		return 1;
+	}
+
+	std::map<Key, Size> all;
+	bool over = false;
+	bool missing = false;
+	bool ramOk = true;
+
+	for(const std::string &path : opt.maps)
+	{
+		kk::MapFile map;
+		if(!map.load(path))
+		{
+			std::fprintf(stderr, "kk_footprint: %s\n", map.error().c_str());
+			return 1;
+		}
+
+		std::string board = boardName(path);
+		std::map<std::string, Size> modules;
+		std::map<std::string, std::map<std::string, uint64_t>> objects;
+		uint64_t reserved = 0;
+
+		for(const kk::MapOutput &out : map.outputs())
+			if(out.name == "._user_heap_stack")
+				reserved += out.size;
+
+		for(const kk::MapInput &in : map.inputs())
+		{
+			if(in.size == 0 || map.outputs()[in.output].name == "._user_heap_stack")
+				continue;
+
+			std::string module = moduleOf(in);
+			account(map, in, modules[module]);
+			objects[module][in.file.empty() ? "*fill*" : kk::objectName(in.file)] += in.size;
+		}
+
+		std::printf("== %s (%s)\n", board.c_str(), path.c_str());
+		std::printf("%-14s %8s %8s %8s %8s %9s %8s", "module", "text", "rodata", "data", "bss", "flash", "ram");
+		if(!opt.comparePath.empty())
+			std::printf("  %17s", "budget flash/ram");
+		std::printf("\n");
+
+		// Largest flash users first
+		std::vector<std::pair<std::string, Size>> sorted(modules.begin(), modules.end());
+		std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+			return a.second.flash() != b.second.flash() ? a.second.flash() > b.second.flash() : a.first < b.first;
+		});
+
+		Size total;
+		for(const auto &m : sorted)
+		{
+			const Size &s = m.second;
+			total.add(s);
+			all[Key(board, m.first)] = s;
+
+			std::printf("%-14s %8llu %8llu %8llu %8llu %9llu %8llu", m.first.c_str(), (unsigned long long)s.text,
+				(unsigned long long)s.rodata, (unsigned long long)s.data, (unsigned long long)s.bss,
+				(unsigned long long)s.flash(), (unsigned long long)s.ram());
+
+			if(!opt.comparePath.empty() && m.first != "fill")
+			{
+				auto b = budget.find(Key(board, m.first));
+				if(b == budget.end())
+				{
+					missing = true;
+					std::printf("  %17s", "NO BUDGET");
+				}
+				else
+				{
+					bool flashOver = s.flash() > b->second.flash;
+					bool ramOver = s.ram() > b->second.ram;
+					over |= flashOver || ramOver;
+					std::printf("  %8llu/%8llu%s", (unsigned long long)b->second.flash, (unsigned long long)b->second.ram,
+						flashOver || ramOver ? "  OVER" : "");
+				}
+			}
+			std::printf("\n");
+
+			if(opt.verbose)
+				for(const auto &o : objects[m.first])
+					std::printf("    %-40s %8llu\n", o.first.c_str(), (unsigned long long)o.second);
+		}
+
+		std::printf("%-14s %8llu %8llu %8llu %8llu %9llu %8llu\n", "total", (unsigned long long)total.text,
+			(unsigned long long)total.rodata, (unsigned long long)total.data, (unsigned long long)total.bss,
+			(unsigned long long)total.flash(), (unsigned long long)total.ram());
+
+		for(const kk::MapRegion &r : map.regions())
+		{
+			uint64_t used = contains(r.name, "FLASH") ? total.flash() : contains(r.name, "RAM") ? total.ram() + reserved : 0;
+			if(used)
+				std::printf("%s: %.1f of %.1f KiB (%.1f %%)%s\n", r.name.c_str(), kib(used), kib(r.length), 100.0 * used / r.length,
+					contains(r.name, "RAM") && reserved ? " including heap and stack reservation" : "");
+		}
+
+		if(!ramList.empty())
+			ramOk &= checkRam(map, board, ramList);
+	}
+
+	if(!opt.writePath.empty())
+	{
+		std::ofstream csv(opt.writePath);
+		if(!csv)
+		{
+			std::fprintf(stderr, "kk_footprint: cannot write %s\n", opt.writePath.c_str());
+			return 1;
+		}
+		csv << "board,module,flash,ram\n";
+		for(const auto &m : all)
+			if(m.first.second != "fill")
+				csv << m.first.first << ',' << m.first.second << ',' << withMargin(m.second.flash(), opt.margin) << ','
+					<< withMargin(m.second.ram(), opt.margin) << '\n';
+	}
+
+	if(over)
+		std::printf("footprint over budget %s\n", opt.comparePath.c_str());
+	if(missing)
+		std::printf("modules without a budget in %s\n", opt.comparePath.c_str());
+	if(!ramOk)
+		std::printf("code listed in %s not placed in RAM\n", opt.ramPath.c_str());
+	return over || missing || !ramOk ? 3 : 0;
+}
@@ -0,0 +1,148 @@
+/*
+Library for:				Host stand-in for stm32f4xx_hal.h - what NRF24.c needs with NRF24_USE_LL 0
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32CubeF4 HAL (stm32f4xx_hal_spi.h, stm32f4xx_hal_gpio.h, stm32f446xx.h)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Peripheral bases are the STM32F446 ones, so the KK_PIN.h compile-time checks and the CubeMX pin
+labels of main.h work unchanged. GPIO ports are never dereferenced - HAL_GPIO_WritePin compares
+the port and pin with the NRF24 labels. SPI handles point to a host SPI_TypeDef, NRF24_spiSpeed
+writes its CR1 and the BaudRatePrescaler the emulator clocks bytes with. Functions are in
+nrf24sim_hal.cpp.
+*/
+
+#ifndef STM32F4XX_HAL_H
+#define STM32F4XX_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Types */
+
+typedef enum
+{
+	HAL_OK = 0x00,
+	HAL_ERROR = 0x01,
+	HAL_BUSY = 0x02,
+	HAL_TIMEOUT = 0x03
+} HAL_StatusTypeDef;
+
+typedef enum
+{
+	GPIO_PIN_RESET = 0,
+	GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct
+{
+	volatile uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2];
+} GPIO_TypeDef;
+
+typedef struct
+{
+	volatile uint32_t CR1, CR2, SR, DR, CRCPR, RXCRCR, TXCRCR, I2SCFGR, I2SPR;
+} SPI_TypeDef;
+
+typedef struct
+{
+	uint32_t Mode;
+	uint32_t Direction;
+	uint32_t DataSize;
+	uint32_t CLKPolarity;
+	uint32_t CLKPhase;
+	uint32_t NSS;
+	uint32_t BaudRatePrescaler;
+	uint32_t FirstBit;
+	uint32_t TIMode;
+	uint32_t CRCCalculation;
+	uint32_t CRCPolynomial;
+} SPI_InitTypeDef;
+
+typedef struct
+{
+	SPI_TypeDef *Instance;
+	SPI_InitTypeDef Init;
+} SPI_HandleTypeDef;
+
+/* Memory map */
+
+#define PERIPH_BASE					0x40000000UL
+#define APB1PERIPH_BASE				PERIPH_BASE
+#define APB2PERIPH_BASE				(PERIPH_BASE + 0x00010000UL)
+#define AHB1PERIPH_BASE				(PERIPH_BASE + 0x00020000UL)
+
+#define GPIOA_BASE					(AHB1PERIPH_BASE + 0x0000UL)
+#define GPIOB_BASE					(AHB1PERIPH_BASE + 0x0400UL)
+#define GPIOC_BASE					(AHB1PERIPH_BASE + 0x0800UL)
+#define GPIOD_BASE					(AHB1PERIPH_BASE + 0x0C00UL)
+#define GPIOE_BASE					(AHB1PERIPH_BASE + 0x1000UL)
+#define GPIOF_BASE					(AHB1PERIPH_BASE + 0x1400UL)
+#define GPIOG_BASE					(AHB1PERIPH_BASE + 0x1800UL)
+#define GPIOH_BASE					(AHB1PERIPH_BASE + 0x1C00UL)
+
+#define GPIOA						((GPIO_TypeDef *)GPIOA_BASE)
+#define GPIOB						((GPIO_TypeDef *)GPIOB_BASE)
+#define GPIOC						((GPIO_TypeDef *)GPIOC_BASE)
+#define GPIOD						((GPIO_TypeDef *)GPIOD_BASE)
+#define GPIOE						((GPIO_TypeDef *)GPIOE_BASE)
+#define GPIOF						((GPIO_TypeDef *)GPIOF_BASE)
+#define GPIOG						((GPIO_TypeDef *)GPIOG_BASE)
+#define GPIOH						((GPIO_TypeDef *)GPIOH_BASE)
+
+/* GPIO */
+
+#define GPIO_PIN_0					((uint16_t)0x0001)
+#define GPIO_PIN_1					((uint16_t)0x0002)
+#define GPIO_PIN_2					((uint16_t)0x0004)
+#define GPIO_PIN_3					((uint16_t)0x0008)
+#define GPIO_PIN_4					((uint16_t)0x0010)
+#define GPIO_PIN_5					((uint16_t)0x0020)
+#define GPIO_PIN_6					((uint16_t)0x0040)
+#define GPIO_PIN_7					((uint16_t)0x0080)
+#define GPIO_PIN_8					((uint16_t)0x0100)
+#define GPIO_PIN_9					((uint16_t)0x0200)
+#define GPIO_PIN_10					((uint16_t)0x0400)
+#define GPIO_PIN_11					((uint16_t)0x0800)
+#define GPIO_PIN_12					((uint16_t)0x1000)
+#define GPIO_PIN_13					((uint16_t)0x2000)
+#define GPIO_PIN_14					((uint16_t)0x4000)
+#define GPIO_PIN_15					((uint16_t)0x8000)
+
+/* SPI registers */
+
+#define SPI_CR1_BR_Pos				3U
+#define SPI_CR1_BR					(0x7UL << SPI_CR1_BR_Pos)
+#define SPI_CR1_SPE					(0x1UL << 6U)
+#define SPI_SR_RXNE					(0x1UL << 0U)
+#define SPI_SR_TXE					(0x1UL << 1U)
+#define SPI_SR_BSY					(0x1UL << 7U)
+
+#define READ_REG(REG)				((REG))
+#define WRITE_REG(REG, VAL)			((REG) = (VAL))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) \
+									WRITE_REG((REG), (((READ_REG(REG)) & (~(CLEARMASK))) | (SETMASK)))
+
+/* Functions */
+
+void HAL_Delay(uint32_t Delay);
+uint32_t HAL_GetTick(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData,
+										  uint16_t Size, uint32_t Timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
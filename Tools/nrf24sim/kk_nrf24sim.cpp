@@ -0,0 +1,468 @@
+/*
+Program for:				NRF24 driver on the host - functional check and SPI cost per driver call
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Boat_RX/Src/NRF24.c built with NRF24_USE_LL 0
+							- Tools/nrf24sim/nrf24sim.h nRF24L01 model
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:	kk_nrf24sim [options]
+
+		-p <Hz>			SPI bus clock (default 42000000 - SPI2 on APB1 at 84 MHz HCLK)
+		-o <ns>			software cost of one HAL_SPI call added to the wire time (default 0)
+		-u <us>			chip power-up time Tpd2stby (default 150, datasheet worst case 1500)
+		-v				print every SPI transaction
+		-w <file>		save results as baseline CSV
+		-c <file>		compare against baseline CSV
+		-t <percent>	allowed growth of simulated time before it counts as regression (default 0)
+
+Runs the driver calls of both boards against two simulated chips: TX init, pipe, blocking and
+split write; RX init, pipe, listening, a packet taken from the TX chip and read back. Every call
+reports SPI transactions (CSN low to high), bytes, HAL_SPI calls, CE / CSN writes and simulated
+time, HAL_Delay included. The model is deterministic - any growth of bytes or transactions is a
+regression regardless of -t.
+
+Between the split write halves radioTask waits with TASK_WAIT_EVENT_TIMEOUT for the IRQ line -
+its EXTI ends the wait within a us, the timeout counts whole ticks and alone ends the wait on a
+board without the IRQ wire. The run repeats the split write with NRF24_writeStart at every 100 us
+of a tick, with and without the IRQ wire, at -u and at the datasheet worst case Tpd2stby of
+1500 us - a packet lost in any of them is a driver failure.
+
+Exit status is 1 when the driver misbehaves (wrong result, payload or register, a command the
+chip rejects) and 3 when comparison found a regression or a call missing from the run.
+*/
+
+#include "nrf24sim.h"
+#include "nrf24sim_hal.h"
+
+extern "C" {
+#include "NRF24.h"
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Options
+{
+	uint32_t pclk = 42000000;
+	uint64_t overheadNs = 0;
+	uint64_t startupUs = 150;
+	bool verbose = false;
+	std::string writePath;
+	std::string comparePath;
+	double threshold = 0.0;
+};
+
+struct Result
+{
+	uint64_t transactions = 0;
+	uint64_t bytes = 0;
+	uint64_t spiCalls = 0;
+	uint64_t gpioWrites = 0;
+	uint64_t timeNs = 0;
+};
+
+// Board and driver call
+using Key = std::pair<std::string, std::string>;
+
+// Both boards open this pipe - tx_pipe_addr / rx_pipe_addr in main.c
+constexpr uint64_t PIPE_ADDRESS = 0x11223344AA;
+
+constexpr uint64_t TICK_NS = 1000000;			// SysTick, HAL_GetTick resolution
+constexpr uint64_t WORST_STARTUP_US = 1500;		// Tpd2stby with a slow crystal
+constexpr uint64_t IRQ_STEP_NS = 1000;			// IRQ pin to radioTask running, EXTI and scheduler pass
+
+void usage()
+{
+	std::fprintf(stderr, "usage: kk_nrf24sim [-p Hz] [-o ns] [-u us] [-v] [-w baseline.csv] [-c baseline.csv] [-t percent]\n");
+	std::exit(2);
+}
+
+Options parse(int argc, char **argv)
+{
+	Options opt;
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if(arg == "-v")
+		{
+			opt.verbose = true;
+			continue;
+		}
+		if(i + 1 >= argc)
+			usage();
+
+		if(arg == "-p")
+			opt.pclk = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if(arg == "-o")
+			opt.overheadNs = std::strtoull(argv[++i], nullptr, 10);
+		else if(arg == "-u")
+			opt.startupUs = std::strtoull(argv[++i], nullptr, 10);
+		else if(arg == "-w")
+			opt.writePath = argv[++i];
+		else if(arg == "-c")
+			opt.comparePath = argv[++i];
+		else if(arg == "-t")
+			opt.threshold = std::strtod(argv[++i], nullptr);
+		else
+			usage();
+	}
+
+	if(opt.pclk == 0 || opt.threshold < 0)
+		usage();
+	return opt;
+}
+
+std::vector<std::string> split(const std::string &line)
+{
+	std::vector<std::string> fields;
+	std::stringstream stream(line);
+	std::string field;
+	while(std::getline(stream, field, ','))
+		fields.push_back(field);
+	return fields;
+}
+
+uint64_t toUint(const std::string &text)
+{
+	return std::strtoull(text.c_str(), nullptr, 10);
+}
+
+bool readBaseline(const std::string &path, std::map<Key, Result> &baseline)
+{
+	std::ifstream file(path);
+	if(!file)
+		return false;
+
+	std::string line;
+	std::getline(file, line);
+	while(std::getline(file, line))
+	{
+		std::vector<std::string> f = split(line);
+		if(f.size() != 7)
+			continue;
+
+		Result &r = baseline[Key(f[0], f[1])];
+		r.transactions = toUint(f[2]);
+		r.bytes = toUint(f[3]);
+		r.spiCalls = toUint(f[4]);
+		r.gpioWrites = toUint(f[5]);
+		r.timeNs = toUint(f[6]);
+	}
+	return true;
+}
+
+std::string bytes(const std::vector<uint8_t> &data)
+{
+	std::string text;
+	char byte[4];
+	for(uint8_t value : data)
+	{
+		std::snprintf(byte, sizeof(byte), "%s%02x", text.empty() ? "" : " ", value);
+		text += byte;
+	}
+	return text;
+}
+
+// Runs the driver calls, keeps results in call order and every misbehaviour found
+class Runner
+{
+public:
+	explicit Runner(const Options &opt) : opt_(opt)
+	{
+		std::memset(&hspi_, 0, sizeof(hspi_));
+		hspi_.Instance = kk::halSpiInstance();
+		kk::halSetCallOverhead(opt.overheadNs);
+	}
+
+	void board(const std::string &name, kk::Nrf24Sim &chip)
+	{
+		board_ = name;
+		chip_ = &chip;
+		chip.setStartup(opt_.startupUs * 1000);
+		if(opt_.verbose)
+			chip.setTrace([name](const std::string &line) { std::printf("  %s  %s\n", name.c_str(), line.c_str()); });
+		kk::halAttach(&chip, opt_.pclk);
+	}
+
+	void measure(const std::string &call, const std::function<void()> &driverCall)
+	{
+		kk::Nrf24Sim::Counters chipBefore = chip_->counters();
+		kk::HalCounters halBefore = kk::halCounters();
+		uint64_t timeBefore = chip_->now();
+
+		if(opt_.verbose)
+			std::printf("%s %s\n", board_.c_str(), call.c_str());
+		driverCall();
+
+		Result r;
+		r.transactions = chip_->counters().transactions - chipBefore.transactions;
+		r.bytes = chip_->counters().bytes - chipBefore.bytes;
+		r.spiCalls = kk::halCounters().spiCalls - halBefore.spiCalls;
+		r.gpioWrites = kk::halCounters().gpioWrites - halBefore.gpioWrites;
+		r.timeNs = chip_->now() - timeBefore;
+
+		order_.push_back(Key(board_, call));
+		results[order_.back()] = r;
+	}
+
+	void expect(bool ok, const std::string &what)
+	{
+		if(!ok)
+			failures.push_back(board_ + ": " + what);
+	}
+
+	void expectRegister(uint8_t reg, const std::vector<uint8_t> &value, const std::string &name)
+	{
+		std::vector<uint8_t> actual = chip_->regBytes(reg);
+		actual.resize(value.size());
+		expect(actual == value, name + " is " + bytes(actual) + ", expected " + bytes(value));
+	}
+
+	void chipErrors(const kk::Nrf24Sim &chip, const std::string &name)
+	{
+		for(const std::string &text : chip.errors())
+			failures.push_back(name + ": chip rejected - " + text);
+	}
+
+	SPI_HandleTypeDef *hspi() { return &hspi_; }
+	uint64_t startupUs() const { return opt_.startupUs; }
+	const std::vector<Key> &order() const { return order_; }
+
+	std::map<Key, Result> results;
+	std::vector<std::string> failures;
+
+private:
+	const Options &opt_;
+	SPI_HandleTypeDef hspi_;
+	std::string board_;
+	kk::Nrf24Sim *chip_ = nullptr;
+	std::vector<Key> order_;
+};
+
+// TASK_WAIT_EVENT_TIMEOUT(t, radio_irq, NRF24_TX_TIMEOUT) of radioTask - the IRQ pin going low
+// ends it, otherwise TASK_NOW() reaching now + NRF24_TX_TIMEOUT + 1
+void taskWait(kk::Nrf24Sim &chip, bool irqWired)
+{
+	uint64_t wake = (chip.now() / TICK_NS + NRF24_TX_TIMEOUT + 1) * TICK_NS;
+
+	while(!(irqWired && chip.irq()) && chip.now() < wake)
+		chip.advance(std::min(IRQ_STEP_NS, wake - chip.now()));
+}
+
+// Split write with NRF24_writeStart at every 100 us of a tick, at the given Tpd2stby
+void sweep(Runner &runner, kk::Nrf24Sim &tx, uint64_t startupUs, bool irqWired)
+{
+	tx.setStartup(startupUs * 1000);
+
+	for(uint64_t phase = 0; phase < TICK_NS; phase += 100000)
+	{
+		const uint8_t payload[PAYLOAD_SIZE] = { 50, 50, static_cast<uint8_t>(phase / 100000) };
+		size_t sent = tx.transmitted().size();
+
+		uint64_t tick = (tx.now() / TICK_NS + 1) * TICK_NS;
+		tx.advance(tick + phase - tx.now());
+
+		NRF24_writeStart(payload, PAYLOAD_SIZE);
+		taskWait(tx, irqWired);
+		uint8_t result = NRF24_writeFinish();
+
+		std::string when = std::string("split write ") + (irqWired ? "on IRQ" : "without IRQ wire") + " at Tpd2stby " +
+						   std::to_string(startupUs) + " us, NRF24_writeStart " + std::to_string(phase / 1000) +
+						   " us into the tick";
+		runner.expect(result != 0, when + " - NRF24_writeFinish returned 0");
+		runner.expect(tx.transmitted().size() == sent + 1 &&
+					  tx.transmitted().back().payload == std::vector<uint8_t>(payload, payload + PAYLOAD_SIZE),
+					  when + " - payload not sent");
+	}
+
+	tx.setStartup(runner.startupUs() * 1000);
+}
+
+// Same sequence as both main.c files, checked against the chip state after each call
+void run(Runner &runner, kk::Nrf24Sim &tx, kk::Nrf24Sim &rx)
+{
+	const std::vector<uint8_t> address = { 0xAA, 0x44, 0x33, 0x22, 0x11 };
+	const uint8_t first[PAYLOAD_SIZE] = { 50, 50, 1 };
+	const uint8_t second[PAYLOAD_SIZE] = { 90, 10, 2 };
+	uint8_t result = 0;
+
+	// TX board
+	runner.board("tx", tx);
+
+	runner.measure("NRF24_init", [&] { NRF24_init(runner.hspi()); });
+	runner.expectRegister(REG_CONFIG, { 0x0C }, "CONFIG after init");
+	runner.expectRegister(REG_RF_CH, { 52 }, "RF_CH after init");
+	runner.expectRegister(REG_EN_AA, { 0x00 }, "EN_AA after init");
+
+	runner.measure("NRF24_openWritingPipe", [&] { NRF24_openWritingPipe(PIPE_ADDRESS); });
+	runner.expectRegister(REG_TX_ADDR, address, "TX_ADDR");
+	runner.expectRegister(REG_RX_PW_P0, { PAYLOAD_SIZE }, "RX_PW_P0");
+
+	runner.measure("NRF24_write", [&] { result = NRF24_write(first, PAYLOAD_SIZE); });
+	runner.expect(result != 0, "NRF24_write returned 0 - TX_DS not set");
+	runner.expect(tx.transmitted().size() == 1, "NRF24_write sent " + std::to_string(tx.transmitted().size()) + " packets");
+
+	// Task waits between the halves, CE stays high
+	runner.measure("NRF24_writeStart", [&] { NRF24_writeStart(second, PAYLOAD_SIZE); });
+	runner.measure("TASK_WAIT_EVENT_TIMEOUT", [&] { taskWait(tx, true); });
+	runner.measure("NRF24_writeFinish", [&] { result = NRF24_writeFinish(); });
+	runner.expect(result != 0, "NRF24_writeFinish returned 0 - TX_DS not set");
+	runner.expect(tx.transmitted().size() == 2 &&
+				  tx.transmitted().back().payload == std::vector<uint8_t>(second, second + PAYLOAD_SIZE),
+				  "split write did not send the payload");
+	runner.expect(tx.txCount() == 0, "TX FIFO not empty after NRF24_writeFinish");
+
+	runner.measure("NRF24_readRegister", [&] { result = NRF24_readRegister(REG_RF_CH); });
+	runner.expect(result == 52, "NRF24_readRegister(RF_CH) returned " + std::to_string(result));
+	runner.measure("NRF24_writeRegister", [&] { NRF24_writeRegister(REG_RF_CH, 52); });
+
+	// RX board - second chip, NRF24_init rebinds the driver
+	runner.board("rx", rx);
+
+	runner.measure("NRF24_init", [&] { NRF24_init(runner.hspi()); });
+	runner.measure("NRF24_openReadingPipe", [&] { NRF24_openReadingPipe(1, PIPE_ADDRESS); });
+	runner.expectRegister(REG_RX_ADDR_P1, address, "RX_ADDR_P1");
+	runner.expectRegister(REG_RX_PW_P1, { PAYLOAD_SIZE }, "RX_PW_P1");
+
+	runner.measure("NRF24_startListening", [&] { NRF24_startListening(); });
+	runner.expect(rx.listening(), "not listening after NRF24_startListening");
+
+	runner.measure("NRF24_available/empty", [&] { result = NRF24_available(); });
+	runner.expect(result == 0, "NRF24_available reported a packet on an empty FIFO");
+
+	// Packet the TX chip put on air
+	if(!tx.transmitted().empty())
+	{
+		const kk::Nrf24Sim::Packet &packet = tx.transmitted().back();
+		runner.expect(rx.deliver(packet.address, packet.payload), "packet from TX not taken by RX pipe 1");
+	}
+
+	runner.measure("NRF24_available", [&] { result = NRF24_available(); });
+	runner.expect(result != 0, "NRF24_available missed the packet");
+
+	uint8_t buffer[PAYLOAD_SIZE] = { 0 };
+	runner.measure("NRF24_read", [&] { result = NRF24_read(buffer, PAYLOAD_SIZE); });
+	runner.expect(std::memcmp(buffer, second, PAYLOAD_SIZE) == 0, "NRF24_read returned " +
+				  bytes(std::vector<uint8_t>(buffer, buffer + PAYLOAD_SIZE)));
+	runner.expect(result != 0, "NRF24_read reported RX FIFO not empty");
+
+	// Task wait against the chip start-up, outside the measured calls
+	runner.board("tx", tx);
+	for(bool irqWired : { true, false })
+	{
+		sweep(runner, tx, runner.startupUs(), irqWired);
+		if(runner.startupUs() != WORST_STARTUP_US)
+			sweep(runner, tx, WORST_STARTUP_US, irqWired);
+	}
+
+	runner.chipErrors(tx, "tx");
+	runner.chipErrors(rx, "rx");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options opt = parse(argc, argv);
+
+	std::map<Key, Result> baseline;
+	if(!opt.comparePath.empty() && !readBaseline(opt.comparePath, baseline))
+	{
+		std::fprintf(stderr, "kk_nrf24sim: cannot read %s\n", opt.comparePath.c_str());
+		return 1;
+	}
+
+	kk::Nrf24Sim tx;
+	kk::Nrf24Sim rx;
+	Runner runner(opt);
+	run(runner, tx, rx);
+
+	std::printf("%-4s %-24s %6s %6s %6s %6s %10s", "", "call", "trans", "bytes", "spi", "pins", "time us");
+	if(!baseline.empty())
+		std::printf(" %10s %8s", "baseline", "change");
+	std::printf("\n");
+
+	bool regression = false;
+	for(const Key &key : runner.order())
+	{
+		const Result &r = runner.results[key];
+		std::printf("%-4s %-24s %6llu %6llu %6llu %6llu %10.2f", key.first.c_str(), key.second.c_str(),
+					static_cast<unsigned long long>(r.transactions), static_cast<unsigned long long>(r.bytes),
+					static_cast<unsigned long long>(r.spiCalls), static_cast<unsigned long long>(r.gpioWrites),
+					r.timeNs / 1000.0);
+
+		auto base = baseline.find(key);
+		if(base != baseline.end())
+		{
+			const Result &b = base->second;
+			double change = b.timeNs ? 100.0 * (static_cast<double>(r.timeNs) - b.timeNs) / b.timeNs : 0.0;
+			bool worse = r.transactions > b.transactions || r.bytes > b.bytes || r.spiCalls > b.spiCalls ||
+						 r.gpioWrites > b.gpioWrites || change > opt.threshold;
+			regression |= worse;
+			std::printf(" %10.2f %+7.1f%%%s", b.timeNs / 1000.0, change, worse ? "  REGRESSION" : "");
+		}
+		else if(!baseline.empty())
+			std::printf(" %10s", "new");
+		std::printf("\n");
+	}
+
+	// Calls that disappeared hide regressions as well
+	for(const auto &entry : baseline)
+	{
+		if(runner.results.find(entry.first) == runner.results.end())
+		{
+			std::printf("%-4s %-24s missing from run\n", entry.first.first.c_str(), entry.first.second.c_str());
+			regression = true;
+		}
+	}
+
+	std::printf("packets        tx sent %llu, rx received %llu, dropped %llu\n",
+				static_cast<unsigned long long>(tx.counters().sent),
+				static_cast<unsigned long long>(rx.counters().received),
+				static_cast<unsigned long long>(rx.counters().dropped));
+
+	if(!opt.writePath.empty())
+	{
+		std::ofstream csv(opt.writePath);
+		if(!csv)
+		{
+			std::fprintf(stderr, "kk_nrf24sim: cannot write %s\n", opt.writePath.c_str());
+			return 1;
+		}
+		csv << "board,call,transactions,bytes,spi_calls,gpio_writes,time_ns\n";
+		for(const Key &key : runner.order())
+		{
+			const Result &r = runner.results[key];
+			csv << key.first << ',' << key.second << ',' << r.transactions << ',' << r.bytes << ',' << r.spiCalls
+				<< ',' << r.gpioWrites << ',' << r.timeNs << '\n';
+		}
+	}
+
+	if(!runner.failures.empty())
+	{
+		for(const std::string &failure : runner.failures)
+			std::printf("FAIL           %s\n", failure.c_str());
+		return 1;
+	}
+
+	if(regression)
+	{
+		std::printf("regression against %s (threshold %.1f%%)\n", opt.comparePath.c_str(), opt.threshold);
+		return 3;
+	}
+	return 0;
+}
@@ -0,0 +1,574 @@
+/*
+Library for:				Host model of the nRF24L01 - SPI command set, register map, FIFOs, CE / CSN
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- NRF24L01 & NRF24L01+ Datasheet (6.1 state diagram, 7 Enhanced ShockBurst,
+							  8.3 SPI commands, 9 register map)
+							- Boat_RX/Inc/NRF24.h command and register names
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#include "nrf24sim.h"
+
+extern "C" {
+#include "NRF24.h"
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace kk {
+
+namespace {
+
+constexpr uint64_t US = 1000;
+constexpr uint64_t SETTLING = 130 * US;		// Tstby2a, standby to TX / RX
+
+// STATUS interrupt flags, write 1 to clear
+constexpr uint8_t STATUS_IRQ = (1 << STATUS_RX_DR) | (1 << STATUS_TX_DS) | (1 << STATUS_MAX_RT);
+
+// Writable bits, 0 - read-only register
+const uint8_t WRITE_MASK[0x20] = {
+	0x7F, 0x3F, 0x3F, 0x03, 0xFF, 0x7F, 0x3F, STATUS_IRQ,	// CONFIG - STATUS
+	0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,			// OBSERVE_TX, CD, RX_ADDR_P0 - P5
+	0xFF, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x00,			// TX_ADDR, RX_PW_P0 - P5, FIFO_STATUS
+	0x00, 0x00, 0x00, 0x00, 0x3F, 0x07, 0x00, 0x00,			// reserved, DYNPD, FEATURE
+};
+
+const char *const REG_NAMES[0x20] = {
+	"CONFIG", "EN_AA", "EN_RXADDR", "SETUP_AW", "SETUP_RETR", "RF_CH", "RF_SETUP", "STATUS",
+	"OBSERVE_TX", "CD", "RX_ADDR_P0", "RX_ADDR_P1", "RX_ADDR_P2", "RX_ADDR_P3", "RX_ADDR_P4", "RX_ADDR_P5",
+	"TX_ADDR", "RX_PW_P0", "RX_PW_P1", "RX_PW_P2", "RX_PW_P3", "RX_PW_P4", "RX_PW_P5", "FIFO_STATUS",
+	"0x18", "0x19", "0x1A", "0x1B", "DYNPD", "FEATURE", "0x1E", "0x1F",
+};
+
+bool isAddressRegister(uint8_t address)
+{
+	return address == REG_RX_ADDR_P0 || address == REG_RX_ADDR_P1 || address == REG_TX_ADDR;
+}
+
+std::string hex(const uint8_t *data, size_t len)
+{
+	std::string text;
+	char byte[4];
+	for(size_t i = 0; i < len; i++)
+	{
+		std::snprintf(byte, sizeof(byte), " %02x", data[i]);
+		text += byte;
+	}
+	return text;
+}
+
+} // namespace
+
+Nrf24Sim::Nrf24Sim()
+{
+	reset();
+}
+
+// Reset values - 9 register map
+void Nrf24Sim::reset()
+{
+	std::memset(regs_, 0, sizeof(regs_));
+	regs_[REG_CONFIG][0] = 0x08;
+	regs_[REG_EN_AA][0] = 0x3F;
+	regs_[REG_EN_RXADDR][0] = 0x03;
+	regs_[REG_SETUP_AW][0] = 0x03;
+	regs_[REG_SETUP_RETR][0] = 0x03;
+	regs_[REG_RF_CH][0] = 0x02;
+	regs_[REG_RF_SETUP][0] = 0x0F;
+	std::memset(regs_[REG_RX_ADDR_P0], 0xE7, 5);
+	std::memset(regs_[REG_RX_ADDR_P1], 0xC2, 5);
+	regs_[REG_RX_ADDR_P2][0] = 0xC3;
+	regs_[REG_RX_ADDR_P3][0] = 0xC4;
+	regs_[REG_RX_ADDR_P4][0] = 0xC5;
+	regs_[REG_RX_ADDR_P5][0] = 0xC6;
+	std::memset(regs_[REG_TX_ADDR], 0xE7, 5);
+
+	tx_.clear();
+	rx_.clear();
+	hasLast_ = false;
+	reuse_ = false;
+	activated_ = false;
+	csn_ = true;
+	ce_ = false;
+	mosi_.clear();
+	miso_.clear();
+	mode_ = Mode::PowerDown;
+	poweredAt_ = now_;
+	rxReadyAt_ = now_;
+	txBusy_ = false;
+	retries_ = 0;
+}
+
+/* Pins */
+
+void Nrf24Sim::csn(bool high)
+{
+	if(high == csn_)
+		return;
+	csn_ = high;
+
+	if(!high)
+	{
+		mosi_.clear();
+		miso_.clear();
+		return;
+	}
+
+	counters_.transactions++;
+	if(mosi_.empty())
+		return;
+
+	if(trace_)
+		trace_(decode());
+	finish();
+}
+
+void Nrf24Sim::ce(bool high)
+{
+	if(high == ce_)
+		return;
+	ce_ = high;
+	modeChanged();
+}
+
+/* SPI */
+
+uint8_t Nrf24Sim::transfer(uint8_t mosi)
+{
+	if(csn_)
+	{
+		error("SPI byte with CSN high");
+		return 0xFF;
+	}
+
+	counters_.bytes++;
+	size_t index = mosi_.size();
+	mosi_.push_back(mosi);
+
+	uint8_t miso = 0x00;
+	if(index == 0)
+		miso = status();
+	else
+	{
+		uint8_t cmd = mosi_[0];
+		if(cmd == CMD_R_RX_PAYLOAD)
+		{
+			if(!rx_.empty() && index - 1 < rx_.front().payload.size())
+				miso = rx_.front().payload[index - 1];
+		}
+		else if(cmd == CMD_R_RX_PL_WID)
+			miso = rx_.empty() ? 0 : static_cast<uint8_t>(rx_.front().payload.size());
+		else if((cmd & 0xE0) == CMD_R_REGISTER)
+			miso = readByte(cmd & 0x1F, static_cast<unsigned>(index - 1));
+	}
+
+	miso_.push_back(miso);
+	return miso;
+}
+
+// Command execution on CSN high - 8.3.1 SPI commands
+void Nrf24Sim::finish()
+{
+	uint8_t cmd = mosi_[0];
+	size_t len = mosi_.size() - 1;
+	const uint8_t *data = mosi_.data() + 1;
+
+	if(cmd == CMD_W_TX_PAYLOAD || cmd == CMD_TX_PAYLOAD_NO_ACK ||
+	   (cmd >= CMD_W_ACK_PAYLOAD_P0 && cmd <= CMD_W_ACK_PAYLOAD_P5))
+	{
+		uint8_t feature = regs_[REG_FEATURE][0];
+		if(cmd == CMD_TX_PAYLOAD_NO_ACK && !(feature & (1 << FEATURE_EN_DYN_ACK)))
+			error("W_TX_PAYLOAD_NOACK without FEATURE EN_DYN_ACK");
+		else if(cmd >= CMD_W_ACK_PAYLOAD_P0 && !(feature & (1 << FEATURE_EN_ACK_PAY)))
+			error("W_ACK_PAYLOAD without FEATURE EN_ACK_PAY");
+		else if(len == 0 || len > MAX_PAYLOAD)
+			error("payload of " + std::to_string(len) + " bytes");
+		else if(tx_.size() == FIFO_DEPTH)
+			error("payload written to a full TX FIFO");
+		else
+		{
+			tx_.push_back({std::vector<uint8_t>(data, data + len), cmd != CMD_W_TX_PAYLOAD});
+			reuse_ = false;
+			if(mode_ == Mode::Tx && !txBusy_)
+				startTx(now_, true);
+		}
+	}
+	else if(cmd == CMD_R_RX_PAYLOAD)
+	{
+		if(rx_.empty())
+			error("R_RX_PAYLOAD with RX FIFO empty");
+		else if(len > 0)
+			rx_.pop_front();
+	}
+	else if(cmd == CMD_R_RX_PL_WID)
+	{
+		// Corrupted width - datasheet asks for FLUSH_RX, the model never stores one
+		if(!rx_.empty() && rx_.front().payload.size() > MAX_PAYLOAD)
+			rx_.clear();
+	}
+	else if(cmd == CMD_FLUSH_TX)
+	{
+		tx_.clear();
+		reuse_ = false;
+	}
+	else if(cmd == CMD_FLUSH_RX)
+		rx_.clear();
+	else if(cmd == CMD_REUSE_TX_PL)
+	{
+		if(!hasLast_)
+			error("REUSE_TX_PL before any transmission");
+		else
+		{
+			if(!reuse_)
+				tx_.push_front(last_);
+			reuse_ = true;
+		}
+	}
+	else if(cmd == CMD_ACTIVATE)
+	{
+		if(len == 1 && data[0] == 0x73)
+			activated_ = !activated_;
+		else
+			error("ACTIVATE without 0x73");
+	}
+	else if(cmd == CMD_NOP)
+		;
+	else if((cmd & 0xE0) == CMD_R_REGISTER)
+		;
+	else if((cmd & 0xE0) == CMD_W_REGISTER)
+	{
+		if(len == 0)
+			error("W_REGISTER without data");
+		for(size_t i = 0; i < len; i++)
+			writeByte(cmd & 0x1F, static_cast<unsigned>(i), data[i]);
+	}
+	else
+	{
+		char text[32];
+		std::snprintf(text, sizeof(text), "unknown command 0x%02x", cmd);
+		error(text);
+	}
+}
+
+/* Registers */
+
+uint8_t Nrf24Sim::status() const
+{
+	uint8_t pipe = rx_.empty() ? 0x07 : rx_.front().pipe;
+	uint8_t full = tx_.size() == FIFO_DEPTH ? 1 : 0;
+
+	return static_cast<uint8_t>((regs_[REG_STATUS][0] & STATUS_IRQ) | (pipe << STATUS_RX_P_NO) | (full << STATUS_TX_FULL));
+}
+
+uint8_t Nrf24Sim::fifoStatus() const
+{
+	return static_cast<uint8_t>((reuse_ ? 1 << FIFO_STATUS_TX_REUSE : 0) |
+								(tx_.size() == FIFO_DEPTH ? 1 << FIFO_STATUS_TX_FULL : 0) |
+								(tx_.empty() ? 1 << FIFO_STATUS_TX_EMPTY : 0) |
+								(rx_.size() == FIFO_DEPTH ? 1 << FIFO_STATUS_RX_FULL : 0) |
+								(rx_.empty() ? 1 << FIFO_STATUS_RX_EMPTY : 0));
+}
+
+unsigned Nrf24Sim::addressWidth() const
+{
+	uint8_t aw = regs_[REG_SETUP_AW][0] & 0x03;
+	return aw ? aw + 2U : 5U;
+}
+
+unsigned Nrf24Sim::width(uint8_t address) const
+{
+	return isAddressRegister(address) ? 5U : 1U;
+}
+
+uint8_t Nrf24Sim::readByte(uint8_t address, unsigned index) const
+{
+	if(index >= width(address))
+		return 0x00;
+	if(address == REG_STATUS)
+		return status();
+	if(address == REG_FIFO_STATUS)
+		return fifoStatus();
+	return regs_[address][index];
+}
+
+void Nrf24Sim::writeByte(uint8_t address, unsigned index, uint8_t value)
+{
+	if(index >= width(address))
+		return;
+
+	// nRF24L01 ignores FEATURE and DYNPD until ACTIVATE
+	if((address == REG_FEATURE || address == REG_DYNPD) && !activated_)
+	{
+		if(value)
+			error(std::string(REG_NAMES[address]) + " written before ACTIVATE");
+		return;
+	}
+
+	if(address == REG_STATUS)
+	{
+		regs_[REG_STATUS][0] &= static_cast<uint8_t>(~(value & STATUS_IRQ));
+		return;
+	}
+
+	uint8_t mask = isAddressRegister(address) ? 0xFF : WRITE_MASK[address];
+	if(mask == 0)
+		return;
+	if(value & ~mask)
+		error(std::string(REG_NAMES[address]) + " reserved bits written");
+	if(address == REG_SETUP_AW && (value & 0x03) == 0)
+		error("SETUP_AW illegal address width");
+	if(address >= REG_RX_PW_P0 && address <= REG_RX_PW_P5 && value > MAX_PAYLOAD)
+		error(std::string(REG_NAMES[address]) + " above 32 bytes");
+
+	regs_[address][index] = value & mask;
+
+	if(address == REG_CONFIG)
+		modeChanged();
+}
+
+uint8_t Nrf24Sim::reg(uint8_t address) const
+{
+	return readByte(address & 0x1F, 0);
+}
+
+std::vector<uint8_t> Nrf24Sim::regBytes(uint8_t address) const
+{
+	address &= 0x1F;
+	std::vector<uint8_t> bytes;
+	for(unsigned i = 0; i < width(address); i++)
+		bytes.push_back(readByte(address, i));
+	return bytes;
+}
+
+void Nrf24Sim::error(const std::string &text)
+{
+	char time[32];
+	std::snprintf(time, sizeof(time), "%.3f us: ", static_cast<double>(now_) / US);
+	errors_.push_back(time + text);
+}
+
+/* Radio - 6.1 state diagram */
+
+bool Nrf24Sim::listening() const
+{
+	return mode_ == Mode::Rx && now_ >= rxReadyAt_;
+}
+
+// CONFIG MASK_RX_DR, MASK_TX_DS and MASK_MAX_RT sit at the STATUS bit positions
+bool Nrf24Sim::irq() const
+{
+	return (regs_[REG_STATUS][0] & STATUS_IRQ & ~regs_[REG_CONFIG][0]) != 0;
+}
+
+void Nrf24Sim::modeChanged()
+{
+	uint8_t config = regs_[REG_CONFIG][0];
+	Mode mode = Mode::PowerDown;
+	if(config & (1 << CONFIG_PWR_UP))
+		mode = !ce_ ? Mode::Standby : (config & (1 << CONFIG_PRIM_RX)) ? Mode::Rx : Mode::Tx;
+
+	if(mode == mode_)
+		return;
+
+	// Crystal starts again after power down, Tpd2stby
+	if(mode_ == Mode::PowerDown)
+		poweredAt_ = now_;
+
+	Mode previous = mode_;
+	mode_ = mode;
+
+	if(mode == Mode::PowerDown)
+	{
+		// Packet on air is lost, retransmits stop
+		txBusy_ = false;
+		retries_ = 0;
+	}
+	else if(mode == Mode::Rx && previous != Mode::Rx)
+		rxReadyAt_ = std::max(now_, poweredAt_ + startup_) + SETTLING;
+	else if(mode == Mode::Tx && !txBusy_)
+		startTx(now_, true);
+}
+
+// Next packet from the TX FIFO, nothing while the FIFO is empty or MAX_RT is not cleared
+void Nrf24Sim::startTx(uint64_t from, bool settle)
+{
+	if(tx_.empty() || (regs_[REG_STATUS][0] & (1 << STATUS_MAX_RT)))
+		return;
+
+	uint64_t begin = std::max(from, poweredAt_ + startup_) + (settle ? SETTLING : 0);
+	txBusy_ = true;
+	txDoneAt_ = begin + airTime(tx_.front().payload.size());
+}
+
+void Nrf24Sim::advance(uint64_t ns)
+{
+	uint64_t target = now_ + ns;
+
+	while(txBusy_ && txDoneAt_ <= target)
+	{
+		now_ = txDoneAt_;
+		txDone();
+	}
+	now_ = target;
+}
+
+// Packet left the antenna - 7.4 automatic packet handling
+void Nrf24Sim::txDone()
+{
+	txBusy_ = false;
+
+	const TxEntry &entry = tx_.front();
+	const uint8_t *address = regs_[REG_TX_ADDR];
+	Packet packet;
+	packet.address.assign(address, address + addressWidth());
+	packet.payload = entry.payload;
+	packet.noAck = entry.noAck;
+	packet.time = now_;
+	transmitted_.push_back(packet);
+	counters_.sent++;
+
+	bool autoAck = (regs_[REG_EN_AA][0] & (1 << EN_AA_ENAA_P0)) && !entry.noAck;
+	uint8_t &observe = regs_[REG_OBSERVE_TX][0];
+
+	if(!autoAck || (ack_ && ack_(packet)))
+	{
+		regs_[REG_STATUS][0] |= 1 << STATUS_TX_DS;
+		observe = static_cast<uint8_t>((observe & 0xF0) | retries_);
+		retries_ = 0;
+		if(!reuse_)
+		{
+			last_ = tx_.front();
+			hasLast_ = true;
+			tx_.pop_front();
+		}
+	}
+	else if(retries_ < (regs_[REG_SETUP_RETR][0] & 0x0F))
+	{
+		retries_++;
+		observe = static_cast<uint8_t>((observe & 0xF0) | retries_);
+		startTx(now_ + retransmitDelay(), false);
+		return;
+	}
+	else
+	{
+		// Payload stays in the FIFO, lost packet counter saturates at 15
+		regs_[REG_STATUS][0] |= 1 << STATUS_MAX_RT;
+		uint8_t lost = std::min(15, (observe >> 4) + 1);
+		observe = static_cast<uint8_t>((lost << 4) | retries_);
+		retries_ = 0;
+		return;
+	}
+
+	// CE still high - next payload, REUSE_TX_PL repeats the same one
+	if(mode_ == Mode::Tx)
+		startTx(now_, true);
+}
+
+// Preamble, address, 9-bit packet control field, payload, CRC - 7.3 packet format
+uint64_t Nrf24Sim::airTime(size_t payload) const
+{
+	uint8_t setup = regs_[REG_RF_SETUP][0];
+	uint8_t config = regs_[REG_CONFIG][0];
+	uint64_t rate = (setup & 0x20) ? 250000 : (setup & (1 << RF_SETUP_RF_DR)) ? 2000000 : 1000000;
+	uint64_t crc = (config & (1 << CONFIG_EN_CRC)) ? ((config & (1 << CONFIG_CRCO)) ? 16 : 8) : 0;
+	uint64_t bits = 8 + addressWidth() * 8 + 9 + payload * 8 + crc;
+
+	return bits * 1000000000ULL / rate;
+}
+
+// ARD - 250 us steps
+uint64_t Nrf24Sim::retransmitDelay() const
+{
+	return 250 * US * ((regs_[REG_SETUP_RETR][0] >> SETUP_RETR_ARD) + 1U);
+}
+
+// P0 and P1 compare the full address, P2 - P5 their LSB and the rest of P1
+int Nrf24Sim::matchPipe(const std::vector<uint8_t> &address) const
+{
+	unsigned aw = addressWidth();
+	if(address.size() != aw)
+		return -1;
+
+	for(uint8_t pipe = 0; pipe < 6; pipe++)
+	{
+		if(!(regs_[REG_EN_RXADDR][0] & (1 << pipe)))
+			continue;
+
+		const uint8_t *reg = regs_[REG_RX_ADDR_P0 + pipe];
+		bool match = address[0] == reg[0];
+		for(unsigned i = 1; i < aw && match; i++)
+			match = address[i] == (pipe < 2 ? reg[i] : regs_[REG_RX_ADDR_P1][i]);
+		if(match)
+			return pipe;
+	}
+	return -1;
+}
+
+bool Nrf24Sim::deliver(const std::vector<uint8_t> &address, const std::vector<uint8_t> &payload)
+{
+	int pipe = listening() ? matchPipe(address) : -1;
+	if(pipe < 0 || payload.empty() || payload.size() > MAX_PAYLOAD || rx_.size() == FIFO_DEPTH)
+	{
+		counters_.dropped++;
+		return false;
+	}
+
+	bool dynamic = (regs_[REG_FEATURE][0] & (1 << FEATURE_EN_DPL)) && (regs_[REG_DYNPD][0] & (1 << pipe));
+	if(!dynamic && payload.size() != regs_[REG_RX_PW_P0 + pipe][0])
+	{
+		counters_.dropped++;
+		return false;
+	}
+
+	rx_.push_back({static_cast<uint8_t>(pipe), payload});
+	regs_[REG_STATUS][0] |= 1 << STATUS_RX_DR;
+	counters_.received++;
+	return true;
+}
+
+/* Trace */
+
+std::string Nrf24Sim::decode() const
+{
+	uint8_t cmd = mosi_[0];
+	const uint8_t *out = mosi_.data() + 1;
+	const uint8_t *in = miso_.data() + 1;
+	size_t len = mosi_.size() - 1;
+	char status[24];
+	std::snprintf(status, sizeof(status), "  [status %02x]", miso_[0]);
+
+	std::string text;
+	if(cmd == CMD_R_RX_PAYLOAD)
+		text = "R_RX_PAYLOAD ->" + hex(in, len);
+	else if(cmd == CMD_R_RX_PL_WID)
+		text = "R_RX_PL_WID ->" + hex(in, len);
+	else if(cmd == CMD_W_TX_PAYLOAD)
+		text = "W_TX_PAYLOAD" + hex(out, len);
+	else if(cmd == CMD_TX_PAYLOAD_NO_ACK)
+		text = "W_TX_PAYLOAD_NOACK" + hex(out, len);
+	else if(cmd >= CMD_W_ACK_PAYLOAD_P0 && cmd <= CMD_W_ACK_PAYLOAD_P5)
+		text = "W_ACK_PAYLOAD P" + std::to_string(cmd - CMD_W_ACK_PAYLOAD_P0) + hex(out, len);
+	else if(cmd == CMD_FLUSH_TX)
+		text = "FLUSH_TX";
+	else if(cmd == CMD_FLUSH_RX)
+		text = "FLUSH_RX";
+	else if(cmd == CMD_REUSE_TX_PL)
+		text = "REUSE_TX_PL";
+	else if(cmd == CMD_ACTIVATE)
+		text = "ACTIVATE" + hex(out, len);
+	else if(cmd == CMD_NOP)
+		text = "NOP";
+	else if((cmd & 0xE0) == CMD_R_REGISTER)
+		text = std::string("R_REGISTER ") + REG_NAMES[cmd & 0x1F] + " ->" + hex(in, len);
+	else if((cmd & 0xE0) == CMD_W_REGISTER)
+		text = std::string("W_REGISTER ") + REG_NAMES[cmd & 0x1F] + hex(out, len);
+	else
+		text = "?" + hex(mosi_.data(), mosi_.size());
+
+	return text + status;
+}
+
+} // namespace kk
@@ -0,0 +1,183 @@
+/*
+Library for:				Host model of the nRF24L01 - SPI command set, register map, FIFOs, CE / CSN
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- NRF24L01 & NRF24L01+ Datasheet (6.1 state diagram, 7 Enhanced ShockBurst,
+							  8.3 SPI commands, 9 register map)
+							- Boat_RX/Inc/NRF24.h command and register names
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Model:				One chip behind CSN, CE and SPI. Every byte clocked while CSN is low goes through
+					transfer() - the first one is the command and returns STATUS, the command runs on
+					the CSN rising edge like on the chip (payload pushed or popped, FIFO flushed).
+					Time is simulated in ns and moves only through advance(), radio events due on the
+					way (end of a TX packet, retransmit, RX ready) run at their own time:
+
+						power down --PWR_UP, Tpd2stby--> standby --CE high, Tstby2a 130 us-->
+						TX (PRIM_RX 0, packet from the TX FIFO) or RX (PRIM_RX 1, listening)
+
+					A TX packet takes preamble, address, 9-bit PCF, payload and CRC at the RF_SETUP data
+					rate. Without auto-ack (EN_AA P0, W_TX_PAYLOAD_NOACK) it sets TX_DS when sent, with
+					auto-ack the ack callback decides - no ack means ARC retransmits ARD apart and
+					MAX_RT. Clearing PWR_UP aborts a packet on air. deliver() puts a packet on air for
+					this chip - it lands in the RX FIFO when the chip listens, the address matches an
+					enabled pipe and the width matches RX_PW (or DPL is on).
+					ACTIVATE 0x73 toggles R_RX_PL_WID, W_ACK_PAYLOAD, W_TX_PAYLOAD_NOACK and writes of
+					FEATURE / DYNPD like on the nRF24L01 (the L01+ has them always on).
+					irq() is the active low IRQ pin, CONFIG masks apply like on the chip.
+					Anything the chip would not accept (byte with CSN high, payload on a full FIFO,
+					unknown command, ...) is kept in errors().
+*/
+
+#ifndef NRF24SIM_H
+#define NRF24SIM_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace kk {
+
+class Nrf24Sim
+{
+public:
+	struct Packet
+	{
+		std::vector<uint8_t> address;		// LSB first, as in TX_ADDR
+		std::vector<uint8_t> payload;
+		bool noAck = false;
+		uint64_t time = 0;					// ns, end of the packet on air
+	};
+
+	struct Counters
+	{
+		uint64_t transactions = 0;			// CSN low to CSN high
+		uint64_t bytes = 0;					// SPI bytes with CSN low
+		uint64_t sent = 0;					// TX packets on air, retransmits included
+		uint64_t received = 0;				// packets put into the RX FIFO
+		uint64_t dropped = 0;				// delivered but not taken - not listening, no pipe, FIFO full
+	};
+
+	// Receiver of an auto-ack packet - true when it acknowledges
+	using AckHandler = std::function<bool(const Packet &packet)>;
+	// Decoded SPI transaction - "W_REGISTER CONFIG 0e", called on CSN high
+	using TraceHandler = std::function<void(const std::string &line)>;
+
+	static constexpr unsigned FIFO_DEPTH = 3;
+	static constexpr unsigned MAX_PAYLOAD = 32;
+
+	Nrf24Sim();
+
+	// Power-on reset - registers, FIFOs and pins, the clock keeps running
+	void reset();
+
+	// Pins - CSN low starts a transaction, CE high enables TX / RX
+	void csn(bool high);
+	void ce(bool high);
+	bool csnHigh() const { return csn_; }
+	bool ceHigh() const { return ce_; }
+
+	// One SPI byte - MOSI in, MISO out
+	uint8_t transfer(uint8_t mosi);
+
+	// Simulated clock
+	void advance(uint64_t ns);
+	uint64_t now() const { return now_; }
+
+	// Packet on air addressed to this chip - false when it is not taken
+	bool deliver(const std::vector<uint8_t> &address, const std::vector<uint8_t> &payload);
+
+	// Register contents without SPI traffic, STATUS and FIFO_STATUS as the chip would return them
+	uint8_t reg(uint8_t address) const;
+	std::vector<uint8_t> regBytes(uint8_t address) const;
+
+	// Tpd2stby - 150 us with a fast crystal or external clock, the datasheet allows up to 1.5 ms
+	void setStartup(uint64_t ns) { startup_ = ns; }
+	void setAckHandler(AckHandler handler) { ack_ = std::move(handler); }
+	void setTrace(TraceHandler handler) { trace_ = std::move(handler); }
+
+	const std::vector<Packet> &transmitted() const { return transmitted_; }
+	const Counters &counters() const { return counters_; }
+	const std::vector<std::string> &errors() const { return errors_; }
+
+	size_t txCount() const { return tx_.size(); }
+	size_t rxCount() const { return rx_.size(); }
+	// Powered, CE high, PRIM_RX and the 130 us settling over
+	bool listening() const;
+	// IRQ pin is low - RX_DR, TX_DS or MAX_RT set and not masked in CONFIG
+	bool irq() const;
+
+private:
+	struct TxEntry
+	{
+		std::vector<uint8_t> payload;
+		bool noAck = false;
+	};
+
+	struct RxEntry
+	{
+		uint8_t pipe;
+		std::vector<uint8_t> payload;
+	};
+
+	enum class Mode { PowerDown, Standby, Tx, Rx };
+
+	uint8_t status() const;
+	uint8_t fifoStatus() const;
+	unsigned addressWidth() const;
+	unsigned width(uint8_t address) const;
+
+	uint8_t readByte(uint8_t address, unsigned index) const;
+	void writeByte(uint8_t address, unsigned index, uint8_t value);
+	void finish();
+	void error(const std::string &text);
+
+	// Radio state machine
+	void modeChanged();
+	void startTx(uint64_t from, bool settle);
+	void txDone();
+	uint64_t airTime(size_t payload) const;
+	uint64_t retransmitDelay() const;
+	int matchPipe(const std::vector<uint8_t> &address) const;
+
+	std::string decode() const;
+
+	// Registers - 0x00 - 0x1D, address registers hold 5 bytes LSB first
+	uint8_t regs_[0x20][5];
+	std::deque<TxEntry> tx_;
+	std::deque<RxEntry> rx_;
+	TxEntry last_;						// REUSE_TX_PL source
+	bool hasLast_ = false;
+	bool reuse_ = false;
+	bool activated_ = false;
+	Mode mode_ = Mode::PowerDown;
+
+	bool csn_ = true;
+	bool ce_ = false;
+
+	// Current SPI transaction
+	std::vector<uint8_t> mosi_;
+	std::vector<uint8_t> miso_;
+
+	uint64_t now_ = 0;
+	uint64_t startup_ = 150000;
+	uint64_t poweredAt_ = 0;
+	uint64_t rxReadyAt_ = 0;
+	bool txBusy_ = false;
+	uint64_t txDoneAt_ = 0;
+	unsigned retries_ = 0;
+
+	AckHandler ack_;
+	TraceHandler trace_;
+	std::vector<Packet> transmitted_;
+	Counters counters_;
+	std::vector<std::string> errors_;
+};
+
+} // namespace kk
+
+#endif
@@ -0,0 +1,155 @@
+/*
+Library for:				HAL_SPI / HAL_GPIO / HAL_Delay stand-ins wired to the nRF24L01 model
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32CubeF4 HAL (HAL_SPI_Receive is a full-duplex transfer of the buffer,
+							  HAL_Delay waits Delay + 1 ticks)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#include "nrf24sim_hal.h"
+
+extern "C" {
+#include "main.h"
+}
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+kk::Nrf24Sim *g_chip = nullptr;
+uint32_t g_pclk = 42000000;
+uint64_t g_overhead = 0;
+kk::HalCounters g_counters;
+SPI_TypeDef g_spi;
+
+kk::Nrf24Sim &chip()
+{
+	if(!g_chip)
+	{
+		std::fprintf(stderr, "nrf24sim: HAL called without an attached chip\n");
+		std::exit(1);
+	}
+	return *g_chip;
+}
+
+bool isPin(GPIO_TypeDef *port, uint16_t pin, GPIO_TypeDef *labelPort, uint16_t labelPin)
+{
+	return port == labelPort && pin == labelPin;
+}
+
+// 8 SCK periods, SCK = PCLK / 2^(BR + 1)
+uint64_t byteTime(const SPI_HandleTypeDef *hspi)
+{
+	uint32_t br = (hspi->Init.BaudRatePrescaler & SPI_CR1_BR) >> SPI_CR1_BR_Pos;
+	uint64_t sck = g_pclk >> (br + 1);
+	return sck ? 8ULL * 1000000000ULL / sck : 0;
+}
+
+HAL_StatusTypeDef exchange(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint8_t *rx, uint16_t size)
+{
+	g_counters.spiCalls++;
+	chip().advance(g_overhead);
+
+	uint64_t time = byteTime(hspi);
+	for(uint16_t i = 0; i < size; i++)
+	{
+		uint8_t miso = chip().transfer(tx ? tx[i] : 0xFF);
+		chip().advance(time);
+		if(rx)
+			rx[i] = miso;
+	}
+	return HAL_OK;
+}
+
+} // namespace
+
+namespace kk {
+
+void halAttach(Nrf24Sim *device, uint32_t pclk)
+{
+	g_chip = device;
+	g_pclk = pclk;
+}
+
+void halSetCallOverhead(uint64_t ns)
+{
+	g_overhead = ns;
+}
+
+const HalCounters &halCounters()
+{
+	return g_counters;
+}
+
+SPI_TypeDef *halSpiInstance()
+{
+	return &g_spi;
+}
+
+} // namespace kk
+
+extern "C" {
+
+// Waits until Delay + 1 tick edges passed, like the HAL - 1 to 2 ms for HAL_Delay(1)
+void HAL_Delay(uint32_t Delay)
+{
+	uint64_t now = chip().now();
+	uint64_t until = (now / 1000000ULL + Delay + 1ULL) * 1000000ULL;
+
+	g_counters.delays++;
+	g_counters.delayNs += until - now;
+	chip().advance(until - now);
+}
+
+uint32_t HAL_GetTick(void)
+{
+	return static_cast<uint32_t>(chip().now() / 1000000ULL);
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+	return g_pclk;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void)
+{
+	return g_pclk;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+	bool high = PinState == GPIO_PIN_SET;
+
+	if(isPin(GPIOx, GPIO_Pin, NRF24_CSN_GPIO_Port, NRF24_CSN_Pin))
+		chip().csn(high);
+	else if(isPin(GPIOx, GPIO_Pin, NRF24_CE_GPIO_Port, NRF24_CE_Pin))
+		chip().ce(high);
+	else
+		return;
+
+	g_counters.gpioWrites++;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	(void)Timeout;
+	return exchange(hspi, pData, nullptr, Size);
+}
+
+// Master receive clocks out the buffer it fills - the HAL calls TransmitReceive(pData, pData)
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	(void)Timeout;
+	return exchange(hspi, pData, pData, Size);
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData,
+										  uint16_t Size, uint32_t Timeout)
+{
+	(void)Timeout;
+	return exchange(hspi, pTxData, pRxData, Size);
+}
+
+}
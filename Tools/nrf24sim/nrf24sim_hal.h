@@ -0,0 +1,48 @@
+/*
+Library for:				HAL_SPI / HAL_GPIO / HAL_Delay stand-ins wired to the nRF24L01 model
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- STM32CubeF4 HAL (HAL_SPI_Receive is a full-duplex transfer of the buffer,
+							  HAL_Delay waits Delay + 1 ticks)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:				Attach a chip, then call NRF24_* as the board does. NRF24_CSN / NRF24_CE labels of
+					main.h drive the chip pins, SPI bytes take 8 SCK periods of the simulated clock -
+					SCK is the bus clock divided by the BaudRatePrescaler NRF24_init picked. Both
+					PCLK functions return the same bus clock: the driver picks APB1 or APB2 by
+					instance address and the host SPI_TypeDef has none.
+					Counters only grow - take a copy before a driver call and subtract.
+*/
+
+#ifndef NRF24SIM_HAL_H
+#define NRF24SIM_HAL_H
+
+#include "nrf24sim.h"
+#include "stm32f4xx_hal.h"
+
+#include <cstdint>
+
+namespace kk {
+
+struct HalCounters
+{
+	uint64_t spiCalls = 0;				// HAL_SPI_Transmit / Receive / TransmitReceive
+	uint64_t gpioWrites = 0;			// HAL_GPIO_WritePin on NRF24 pins
+	uint64_t delays = 0;				// HAL_Delay calls
+	uint64_t delayNs = 0;				// simulated time spent in HAL_Delay
+};
+
+// Chip behind the NRF24 pins and SPI, bus clock of the SPI peripheral in Hz
+void halAttach(Nrf24Sim *chip, uint32_t pclk);
+// Software cost of one HAL_SPI call on top of the wire time
+void halSetCallOverhead(uint64_t ns);
+const HalCounters &halCounters();
+
+// Host SPI peripheral for the SPI_HandleTypeDef passed to NRF24_init
+SPI_TypeDef *halSpiInstance();
+
+} // namespace kk
+
+#endif
@@ -0,0 +1,251 @@
+/*
+Program for:				Decoding KK_TRACE events from SWO captures
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Boat_TX/Inc/KK_TRACE.h
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:	kk_swo [options] <capture>
+
+		capture			raw SWO bytes (NRZ, TPIU formatter off), a USB-UART tty on PB3 or "-"
+						e.g. OpenOCD: tpiu config internal trace.swo uart off 84000000 2000000
+		-c <MHz>		core clock at boot for cycle to time conversion (default 84), CLOCK events switch it
+		-b <baud>		tty baud rate (default 2000000, TRACE_SWO_BAUD)
+		-o <file>		write events as CSV
+		-q				summary only, no timeline
+
+Text written to ITM port 0 (printf with debugger attached) is printed line by line.
+*/
+
+#include "kk_input.h"
+#include "kk_itm.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options
+{
+	double mhz = 84.0;
+	unsigned baudrate = 2000000;
+	std::string csvPath;
+	bool quiet = false;
+	std::string input;
+};
+
+// Duration statistics in microseconds
+struct Durations
+{
+	uint64_t count = 0;
+	double sum = 0;
+	double max = 0;
+
+	void add(double us)
+	{
+		count++;
+		sum += us;
+		max = std::max(max, us);
+	}
+};
+
+void usage()
+{
+	std::fprintf(stderr, "usage: kk_swo [-c MHz] [-b baud] [-o events.csv] [-q] <capture>\n");
+	std::exit(2);
+}
+
+Options parse(int argc, char **argv)
+{
+	Options opt;
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if((arg == "-c" || arg == "-b" || arg == "-o") && i + 1 >= argc)
+			usage();
+
+		if(arg == "-c")
+			opt.mhz = std::strtod(argv[++i], nullptr);
+		else if(arg == "-b")
+			opt.baudrate = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+		else if(arg == "-o")
+			opt.csvPath = argv[++i];
+		else if(arg == "-q")
+			opt.quiet = true;
+		else if(arg.size() > 1 && arg[0] == '-')
+			usage();
+		else if(opt.input.empty())
+			opt.input = arg;
+		else
+			usage();
+	}
+
+	if(opt.input.empty() || opt.mhz <= 0)
+		usage();
+	return opt;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options opt = parse(argc, argv);
+
+	kk::Input input;
+	if(!input.open(opt.input, opt.baudrate))
+	{
+		std::fprintf(stderr, "kk_swo: %s\n", input.error().c_str());
+		return 1;
+	}
+
+	std::ofstream csv;
+	if(!opt.csvPath.empty())
+	{
+		csv.open(opt.csvPath);
+		if(!csv)
+		{
+			std::fprintf(stderr, "kk_swo: cannot write %s\n", opt.csvPath.c_str());
+			return 1;
+		}
+		csv << "time_us,event,arg\n";
+	}
+
+	kk::ItmDecoder itm;
+	kk::TraceDecoder trace(opt.mhz);
+	std::vector<kk::ItmPacket> packets;
+	std::vector<kk::TraceEvent> events;
+	uint8_t buffer[4096];
+
+	std::map<uint8_t, uint64_t> counts;
+	std::map<uint32_t, Durations> irqs;
+	std::map<uint32_t, Durations> tasks;
+	Durations radio;
+	std::vector<std::pair<uint32_t, double>> irqStack;
+	std::map<uint32_t, double> taskStart;
+	double radioStart = 0;
+	bool radioPending = false;
+	std::string text;
+
+	long n;
+	while((n = input.read(buffer, sizeof(buffer))) > 0)
+	{
+		packets.clear();
+		events.clear();
+		itm.feed(buffer, static_cast<size_t>(n), packets);
+		trace.feed(packets, events);
+
+		for(const kk::ItmPacket &p : packets)
+		{
+			if(p.port != kk::TRACE_PORT_TEXT || opt.quiet)
+				continue;
+			for(uint8_t i = 0; i < p.size; i++)
+			{
+				char c = static_cast<char>(p.value >> (8 * i));
+				if(c == '\n')
+				{
+					std::printf("%17s  text            %s\n", "", text.c_str());
+					text.clear();
+				}
+				else if(c != '\r')
+					text += c;
+			}
+		}
+
+		for(const kk::TraceEvent &e : events)
+		{
+			double us = e.us;
+			counts[e.event]++;
+
+			if(csv.is_open())
+				csv << static_cast<uint64_t>(us) << ',' << kk::traceName(e.event) << ',' << e.arg << '\n';
+
+			if(!opt.quiet)
+			{
+				std::printf("%14.3f us  %-15s", us, kk::traceName(e.event));
+				if(e.event == kk::TRACE_IRQ_ENTER || e.event == kk::TRACE_IRQ_EXIT)
+					std::printf(" %s\n", kk::irqName(e.arg));
+				else if(e.event == kk::TRACE_TASK_START || e.event == kk::TRACE_TASK_STOP)
+					std::printf(" %s\n", kk::zoneName(static_cast<uint8_t>(e.arg)));
+				else
+					std::printf(" %u\n", e.arg);
+			}
+
+			switch(e.event)
+			{
+			case kk::TRACE_SYNC:
+				irqStack.clear();
+				taskStart.clear();
+				radioPending = false;
+				break;
+			case kk::TRACE_IRQ_ENTER:
+				irqStack.emplace_back(e.arg, us);
+				break;
+			case kk::TRACE_IRQ_EXIT:
+				// Nested handlers exit in reverse order, unmatched exit means lost enter
+				if(!irqStack.empty() && irqStack.back().first == e.arg)
+				{
+					irqs[e.arg].add(us - irqStack.back().second);
+					irqStack.pop_back();
+				}
+				break;
+			case kk::TRACE_TASK_START:
+				taskStart[e.arg] = us;
+				break;
+			case kk::TRACE_TASK_STOP:
+				if(taskStart.count(e.arg))
+				{
+					tasks[e.arg].add(us - taskStart[e.arg]);
+					taskStart.erase(e.arg);
+				}
+				break;
+			case kk::TRACE_RADIO_TX:
+				radioStart = us;
+				radioPending = true;
+				break;
+			case kk::TRACE_RADIO_TX_DONE:
+				if(radioPending)
+					radio.add(us - radioStart);
+				radioPending = false;
+				break;
+			}
+		}
+	}
+	if(n < 0)
+	{
+		std::fprintf(stderr, "kk_swo: %s\n", input.error().c_str());
+		return 1;
+	}
+
+	std::printf("== %s\n", opt.input.c_str());
+	std::printf("itm: %llu syncs, %llu overflows, %llu other packets, %llu unpaired writes\n",
+		static_cast<unsigned long long>(itm.syncs()), static_cast<unsigned long long>(itm.overflows()),
+		static_cast<unsigned long long>(itm.skipped()), static_cast<unsigned long long>(trace.unpaired()));
+	for(const auto &c : counts)
+		std::printf("event %-15s %llu\n", kk::traceName(c.first), static_cast<unsigned long long>(c.second));
+
+	auto print = [&](const char *name, const Durations &d) {
+		std::printf("  %-16s count %8llu mean %10.2f us max %10.2f us\n", name, static_cast<unsigned long long>(d.count),
+			d.sum / d.count, d.max);
+	};
+	if(!irqs.empty())
+		std::printf("interrupts:\n");
+	for(const auto &i : irqs)
+		print(kk::irqName(i.first), i.second);
+	if(!tasks.empty())
+		std::printf("tasks:\n");
+	for(const auto &t : tasks)
+		print(kk::zoneName(static_cast<uint8_t>(t.first)), t.second);
+	if(radio.count)
+	{
+		std::printf("radio:\n");
+		print("tx_to_ack", radio);
+	}
+	return 0;
+}
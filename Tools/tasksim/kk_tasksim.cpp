@@ -0,0 +1,180 @@
+/*
+Program for:				Radio response latency of the boat task graph, bare-metal and FreeRTOS
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Boat_RX/Inc/KK_TASK.h
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:	kk_tasksim [options]
+
+		-c <radio,control,display,telemetry>	CPU time per activation in us (default 100,50,500,2000)
+		-P <control,display,telemetry>			task periods in ms (default 20,200,1000)
+		-p <us>			packet period (default 100000, TX sends every 100 ms)
+		-j <us>			packet jitter +- (default 5000, bare-metal only)
+		-s <ms>			simulated time (default 60000)
+		-l <us>			latency budget - exit status 3 when the worst case is above it
+
+Builds:	kk_tasksim			KK_TASK bare-metal scheduler on a simulated clock, always built
+		kk_tasksim_rtos		KK_TASK FreeRTOS backend on the Posix port, built when CMake gets
+							-DFREERTOS_KERNEL_PATH=<FreeRTOS-Kernel checkout>
+
+Latency is time from the packet landing in the nRF24 RX FIFO to the radio task taking it. The
+IRQ line wakes radioTask, so it is the CPU time of whatever runs when the packet lands: bare-metal
+waits for the running task to return, FreeRTOS preempts everything below TASK_PRIORITY_RADIO.
+Interrupt entry, scheduler passes and context switches are not modelled, on target they add a few
+us. Feed -c with the PROFILER_report averages of the board (LOOP / DISPLAY zones, 'p' command) -
+defaults are placeholders. On target the same comparison comes from SWO captures of both boards:
+kk_timeline pairs RADIO_TX_DONE on TX with RADIO_RX on RX by sequence number for the Debug and the
+FreeRTOS build configurations.
+*/
+
+#include "tasksim.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options
+{
+	TASKSIM_Config config = {
+		100, 50, 500, 2000,		// radio, control, display, telemetry us
+		20, 200, 1000,			// control, display, telemetry ms
+		100000, 5000,			// packet period and jitter us
+		60000,					// duration ms
+	};
+	uint32_t budget = 0;
+};
+
+// Worst case checked against -l, set by report()
+uint32_t g_budget = 0;
+
+void usage()
+{
+	std::fprintf(stderr, "usage: kk_tasksim [-c radio,control,display,telemetry] [-P control,display,telemetry] "
+						 "[-p us] [-j us] [-s ms] [-l us]\n");
+	std::exit(2);
+}
+
+std::vector<uint32_t> parseList(const std::string &text, size_t count)
+{
+	std::vector<uint32_t> values;
+	std::stringstream stream(text);
+	std::string item;
+	while(std::getline(stream, item, ','))
+	{
+		char *end = nullptr;
+		unsigned long value = std::strtoul(item.c_str(), &end, 10);
+		if(item.empty() || *end != '\0')
+			usage();
+		values.push_back(static_cast<uint32_t>(value));
+	}
+	if(values.size() != count)
+		usage();
+	return values;
+}
+
+Options parse(int argc, char **argv)
+{
+	Options opt;
+	TASKSIM_Config &c = opt.config;
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if(i + 1 >= argc)
+			usage();
+
+		if(arg == "-c")
+		{
+			std::vector<uint32_t> v = parseList(argv[++i], 4);
+			c.radioUs = v[0];
+			c.controlUs = v[1];
+			c.displayUs = v[2];
+			c.telemetryUs = v[3];
+		}
+		else if(arg == "-P")
+		{
+			std::vector<uint32_t> v = parseList(argv[++i], 3);
+			c.controlPeriodMs = v[0];
+			c.displayPeriodMs = v[1];
+			c.telemetryPeriodMs = v[2];
+		}
+		else if(arg == "-p")
+			c.packetPeriodUs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if(arg == "-j")
+			c.packetJitterUs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if(arg == "-s")
+			c.durationMs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if(arg == "-l")
+			opt.budget = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else
+			usage();
+	}
+
+	if(c.packetPeriodUs == 0 || c.packetJitterUs >= c.packetPeriodUs || c.durationMs == 0 ||
+	   c.controlPeriodMs == 0 || c.displayPeriodMs == 0 || c.telemetryPeriodMs == 0)
+		usage();
+	return opt;
+}
+
+uint32_t percentile(const std::vector<uint32_t> &sorted, double p)
+{
+	size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+	return sorted[index];
+}
+
+// Called by the model when the simulated time is over - the FreeRTOS build exits from here
+extern "C" void report(const TASKSIM_Config *config, const TASKSIM_Result *result)
+{
+	std::vector<uint32_t> sorted(result->latencyUs, result->latencyUs + result->samples);
+	std::sort(sorted.begin(), sorted.end());
+
+	double cpu = (static_cast<double>(config->controlUs) / config->controlPeriodMs +
+				  static_cast<double>(config->displayUs) / config->displayPeriodMs +
+				  static_cast<double>(config->telemetryUs) / config->telemetryPeriodMs +
+				  static_cast<double>(config->radioUs) * 1000.0 / config->packetPeriodUs) / 10.0;
+
+	std::printf("scheduler      %s\n", TASKSIM_scheduler());
+	std::printf("time           %u ms, load %.1f %%\n", config->durationMs, cpu);
+	std::printf("packets        %u handled, %u lost\n", result->packets, result->lost);
+
+	if(sorted.empty())
+	{
+		std::printf("latency        no packets\n");
+		std::fflush(stdout);
+		return;
+	}
+
+	uint64_t sum = 0;
+	for(uint32_t value : sorted)
+		sum += value;
+
+	std::printf("latency us     min %u  mean %llu  p50 %u  p90 %u  p99 %u  max %u\n", sorted.front(),
+				static_cast<unsigned long long>(sum / sorted.size()), percentile(sorted, 0.50),
+				percentile(sorted, 0.90), percentile(sorted, 0.99), sorted.back());
+
+	if(g_budget && sorted.back() > g_budget)
+	{
+		std::printf("over budget    max %u us > %u us\n", sorted.back(), g_budget);
+		std::fflush(stdout);
+		std::exit(3);
+	}
+	std::fflush(stdout);
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	Options opt = parse(argc, argv);
+	g_budget = opt.budget;
+
+	TASKSIM_run(&opt.config, report);
+	return 0;
+}
@@ -0,0 +1,55 @@
+/*
+Library for:				Host model of the boat task graph - shared by both scheduler builds
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Boat_RX/Inc/KK_TASK.h
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+#ifndef TASKSIM_H
+#define TASKSIM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TASKSIM_FIFO_DEPTH			3			// nRF24L01 RX FIFO, a packet arriving on a full FIFO is lost
+#define TASKSIM_MAX_SAMPLES			65536
+
+typedef struct
+{
+	uint32_t radioUs;				// CPU time per packet - read, mixing, telemetry frame
+	uint32_t controlUs;				// per CONTROL period
+	uint32_t displayUs;				// per DISPLAY period
+	uint32_t telemetryUs;			// per TELEMETRY period
+	uint32_t controlPeriodMs;
+	uint32_t displayPeriodMs;
+	uint32_t telemetryPeriodMs;
+	uint32_t packetPeriodUs;		// radio packet interval
+	uint32_t packetJitterUs;		// +- uniform, simulated clock only
+	uint32_t durationMs;
+} TASKSIM_Config;
+
+typedef struct
+{
+	uint32_t packets;				// handled by the radio task
+	uint32_t lost;					// arrived on a full FIFO
+	uint32_t samples;				// latencies stored, first TASKSIM_MAX_SAMPLES packets
+	const uint32_t *latencyUs;		// arrival to radio task start
+} TASKSIM_Result;
+
+typedef void (*TASKSIM_Done)(const TASKSIM_Config *config, const TASKSIM_Result *result);
+
+// Runs the task graph for durationMs and calls done - the FreeRTOS build does not return from here
+void TASKSIM_run(const TASKSIM_Config *config, TASKSIM_Done done);
+
+// Scheduler the model was built against
+const char *TASKSIM_scheduler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
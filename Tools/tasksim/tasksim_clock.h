@@ -0,0 +1,26 @@
+/*
+Library for:				Simulated clock for the bare-metal KK_TASK build on a host
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Boat_RX/Inc/KK_TASK.h (Host build)
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:				gcc -include tasksim_clock.h - replaces HAL_GetTick and WFI before KK_TASK.h is read.
+					Time only moves when a task burns CPU or the scheduler idles, so results do not
+					depend on the host load.
+*/
+
+#ifndef TASKSIM_CLOCK_H
+#define TASKSIM_CLOCK_H
+
+#include <stdint.h>
+
+uint32_t TASKSIM_nowMs(void);
+void TASKSIM_idle(void);
+
+#define TASK_NOW()					TASKSIM_nowMs()
+#define TASK_IDLE()					TASKSIM_idle()
+
+#endif
@@ -0,0 +1,305 @@
+/*
+Library for:				Host model of the boat task graph - shared by both scheduler builds
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Boat_RX/Inc/KK_TASK.h
+							- Boat_TX/Src/main.c and Boat_RX/Src/main.c task layout
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Tasks:				radio		waits for the nRF24 IRQ event like radioTask on Boat_RX, handles
+								every packet in the RX FIFO
+					control		fixed period (joystick, mixing, clock policy)
+					display		fixed period (DISPLAY_process)
+					telemetry	fixed period (link and loop frames, profiler report)
+
+					A packet lands in the FIFO and its IRQ edge signals the radio event (EXTI callback
+					on the boards). Bare-metal: the interrupt ends WFI at once, a packet arriving while
+					another task burns CPU waits until that task returns. FreeRTOS: the semaphore give
+					preempts lower priority tasks.
+					Bare-metal: tasks run in that order, packets come from a simulated clock and land
+					while a task burns CPU or while the scheduler idles in WFI.
+					FreeRTOS (Posix port): a timer task above TASK_PRIORITY_RADIO puts the packets
+					into the FIFO, CPU time is burnt against CLOCK_MONOTONIC.
+					Scheduler passes, interrupt entry and context switches cost nothing here.
+*/
+
+/* Includes */
+
+#include "tasksim.h"
+#include "KK_TASK.h"
+
+#ifdef USE_FREERTOS
+#include "timers.h"
+#include <stdlib.h>
+#include <time.h>
+#endif
+
+/* Model state */
+
+static const TASKSIM_Config *sim_config;
+static TASKSIM_Done sim_done;
+
+// nRF24 RX FIFO - arrival times in us
+static uint64_t sim_fifo[TASKSIM_FIFO_DEPTH];
+static uint8_t sim_fifoHead;
+static uint8_t sim_fifoCount;
+
+static uint32_t sim_latency[TASKSIM_MAX_SAMPLES];
+static TASKSIM_Result sim_result;
+
+// nRF24 IRQ line through EXTI
+static TASK_Event sim_radioIrq;
+
+/* Static function prototypes */
+
+static uint64_t TASKSIM_nowUs(void);
+static void TASKSIM_burn(uint32_t us);
+static void TASKSIM_irq(void);
+static uint8_t TASKSIM_pop(uint64_t *arrival);
+static void TASKSIM_finish(void);
+static uint8_t radioTask(TASK_Task *t);
+static uint8_t controlTask(TASK_Task *t);
+static uint8_t displayTask(TASK_Task *t);
+static uint8_t telemetryTask(TASK_Task *t);
+
+/* Scheduler backend */
+
+#ifndef USE_FREERTOS
+
+#define TASKSIM_LOCK()				((void)0)
+#define TASKSIM_UNLOCK()			((void)0)
+
+static uint64_t sim_us;
+static uint64_t sim_nextPacket;
+static uint32_t sim_seed = 1;
+
+// Next packet - period +- jitter, LCG keeps runs repeatable
+static void TASKSIM_schedulePacket(void)
+{
+	uint32_t jitter = sim_config->packetJitterUs;
+	uint64_t next = sim_nextPacket + sim_config->packetPeriodUs;
+
+	if(jitter){
+		sim_seed = sim_seed * 1664525U + 1013904223U;
+		next = next + (sim_seed >> 8) % (2U * jitter + 1U) - jitter;
+	}
+	sim_nextPacket = next > sim_us ? next : sim_us + 1U;
+}
+
+// Moves the clock, packets due on the way interrupt at their own time
+static void TASKSIM_advance(uint64_t until)
+{
+	while(sim_nextPacket <= until){
+		sim_us = sim_nextPacket;
+		TASKSIM_irq();
+		TASKSIM_schedulePacket();
+	}
+	sim_us = until;
+}
+
+static uint64_t TASKSIM_nowUs(void)
+{
+	return sim_us;
+}
+
+static void TASKSIM_burn(uint32_t us)
+{
+	TASKSIM_advance(sim_us + us);
+}
+
+uint32_t TASKSIM_nowMs(void)
+{
+	return (uint32_t)(sim_us / 1000U);
+}
+
+// WFI - SysTick or the packet interrupt wakes the core, whichever comes first
+void TASKSIM_idle(void)
+{
+	uint64_t tick = (sim_us / 1000U + 1U) * 1000U;
+
+	TASKSIM_advance(sim_nextPacket < tick ? sim_nextPacket : tick);
+}
+
+const char *TASKSIM_scheduler(void)
+{
+	return "bare-metal";
+}
+
+#else
+
+#define TASKSIM_LOCK()				taskENTER_CRITICAL()
+#define TASKSIM_UNLOCK()			taskEXIT_CRITICAL()
+
+static StaticTimer_t sim_packetTimer;
+static StaticTimer_t sim_stopTimer;
+
+static uint64_t TASKSIM_nowUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000U + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+// Busy loop - the Posix port preempts it like the CPU would be
+static void TASKSIM_burn(uint32_t us)
+{
+	uint64_t end = TASKSIM_nowUs() + us;
+
+	while(TASKSIM_nowUs() < end);
+}
+
+static void TASKSIM_packetCallback(TimerHandle_t timer)
+{
+	(void)timer;
+	TASKSIM_irq();
+}
+
+static void TASKSIM_stopCallback(TimerHandle_t timer)
+{
+	(void)timer;
+	TASKSIM_finish();
+	exit(0);
+}
+
+const char *TASKSIM_scheduler(void)
+{
+	return "freertos-posix";
+}
+
+#endif
+
+/* Functions */
+
+// Packet on air - nRF24 keeps three payloads, the next one is lost. RX_DR pulls the IRQ line
+static void TASKSIM_irq(void)
+{
+	TASKSIM_LOCK();
+	if(sim_fifoCount < TASKSIM_FIFO_DEPTH){
+		sim_fifo[(sim_fifoHead + sim_fifoCount) % TASKSIM_FIFO_DEPTH] = TASKSIM_nowUs();
+		sim_fifoCount++;
+	}
+	else{
+		sim_result.lost++;
+	}
+	TASKSIM_UNLOCK();
+
+	TASK_signal(&sim_radioIrq);
+}
+
+static uint8_t TASKSIM_pop(uint64_t *arrival)
+{
+	uint8_t popped = 0;
+
+	TASKSIM_LOCK();
+	if(sim_fifoCount){
+		*arrival = sim_fifo[sim_fifoHead];
+		sim_fifoHead = (sim_fifoHead + 1) % TASKSIM_FIFO_DEPTH;
+		sim_fifoCount--;
+		popped = 1;
+	}
+	TASKSIM_UNLOCK();
+
+	return popped;
+}
+
+static void TASKSIM_finish(void)
+{
+	sim_result.latencyUs = sim_latency;
+	sim_done(sim_config, &sim_result);
+}
+
+/* Tasks */
+
+static uint8_t radioTask(TASK_Task *t)
+{
+	static uint64_t arrival;
+
+	TASK_BEGIN(t);
+
+	for(;;){
+		TASK_WAIT_EVENT(t, sim_radioIrq);
+
+		while(TASKSIM_pop(&arrival)){
+			if(sim_result.samples < TASKSIM_MAX_SAMPLES)
+				sim_latency[sim_result.samples++] = (uint32_t)(TASKSIM_nowUs() - arrival);
+			sim_result.packets++;
+			TASKSIM_burn(sim_config->radioUs);
+		}
+	}
+
+	TASK_END(t);
+}
+
+static uint8_t controlTask(TASK_Task *t)
+{
+	TASK_BEGIN(t);
+
+	for(;;){
+		TASKSIM_burn(sim_config->controlUs);
+		TASK_SLEEP_PERIOD(t, sim_config->controlPeriodMs);
+	}
+
+	TASK_END(t);
+}
+
+static uint8_t displayTask(TASK_Task *t)
+{
+	TASK_BEGIN(t);
+
+	for(;;){
+		TASKSIM_burn(sim_config->displayUs);
+		TASK_SLEEP_PERIOD(t, sim_config->displayPeriodMs);
+	}
+
+	TASK_END(t);
+}
+
+static uint8_t telemetryTask(TASK_Task *t)
+{
+	TASK_BEGIN(t);
+
+	for(;;){
+		TASKSIM_burn(sim_config->telemetryUs);
+		TASK_SLEEP_PERIOD(t, sim_config->telemetryPeriodMs);
+	}
+
+	TASK_END(t);
+}
+
+// Same priorities as the boards - bare-metal runs them in this order
+static TASK_Task sim_tasks[] = {
+	TASK_INIT(radioTask, TASK_PRIORITY_RADIO),
+	TASK_INIT(controlTask, TASK_PRIORITY_CONTROL),
+	TASK_INIT(displayTask, TASK_PRIORITY_DISPLAY),
+	TASK_INIT(telemetryTask, TASK_PRIORITY_TELEMETRY),
+};
+
+#define TASKSIM_TASKS				(sizeof(sim_tasks) / sizeof(sim_tasks[0]))
+
+void TASKSIM_run(const TASKSIM_Config *config, TASKSIM_Done done)
+{
+	sim_config = config;
+	sim_done = done;
+	TASK_eventInit(&sim_radioIrq);
+
+#ifndef USE_FREERTOS
+	sim_nextPacket = config->packetPeriodUs;
+	TASK_start(sim_tasks, TASKSIM_TASKS);
+
+	while(TASKSIM_nowMs() < config->durationMs)
+		TASK_schedule(sim_tasks, TASKSIM_TASKS);
+
+	TASKSIM_finish();
+#else
+	TickType_t period = pdMS_TO_TICKS((config->packetPeriodUs + 500U) / 1000U);
+
+	xTimerStart(xTimerCreateStatic("packet", period ? period : 1, pdTRUE, NULL,
+								   TASKSIM_packetCallback, &sim_packetTimer), 0);
+	xTimerStart(xTimerCreateStatic("stop", pdMS_TO_TICKS(config->durationMs), pdFALSE, NULL,
+								   TASKSIM_stopCallback, &sim_stopTimer), 0);
+	TASK_start(sim_tasks, TASKSIM_TASKS);
+#endif
+}
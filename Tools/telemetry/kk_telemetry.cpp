@@ -0,0 +1,508 @@
+/*
+Program for:				Recording and analysing KK_TELEMETRY streams
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Boat_TX/Inc/KK_TELEMETRY.h
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:	kk_telemetry [options] <input>...
+
+		input			serial device, pty, capture file or "-" for stdin
+		-b <baud>		serial baud rate (default 460800)
+		-w <file>		save raw bytes of the (single) input for later replay
+		-o <dir>		write columnar log: control.csv link.csv loop.csv event.csv profile.csv memory.csv
+						stack.csv
+		-v				print every decoded frame
+
+Every input is analysed separately; the BOOT event tells which board it came from.
+Live inputs are recorded until Ctrl+C. Profiler reports (DEBUG firmware) are requested by
+sending 'p' to the board, e.g. printf p > /dev/ttyACM0, and cleared with 'r'. 'm' requests
+a RAM usage report (stack high-water mark, heap) from any build, the FreeRTOS build adds the
+high-water mark of every task stack.
+The streams in Tools/telemetry/captures are synthesized for the ctest checks, not recorded on boards.
+*/
+
+#include "kk_frame.h"
+#include "kk_input.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+namespace {
+
+// Inter-arrival histogram, 10 ms buckets, last one catches everything above
+constexpr uint32_t HIST_BUCKET_US = 10000;
+constexpr size_t HIST_BUCKETS = 20;
+
+struct Options
+{
+	unsigned baudrate = kk::DEFAULT_BAUDRATE;
+	std::string rawPath;
+	std::string logDir;
+	bool verbose = false;
+	std::vector<std::string> inputs;
+};
+
+// Percentiles over collected samples
+struct Samples
+{
+	std::vector<uint32_t> values;
+
+	void add(uint32_t value) { values.push_back(value); }
+
+	uint32_t percentile(double p)
+	{
+		if(values.empty())
+			return 0;
+		size_t idx = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+		std::nth_element(values.begin(), values.begin() + idx, values.end());
+		return values[idx];
+	}
+
+	uint32_t max() const
+	{
+		return values.empty() ? 0 : *std::max_element(values.begin(), values.end());
+	}
+};
+
+// Task name of a STACK record, zero padded on the wire
+std::string taskName(const uint8_t *p)
+{
+	const char *name = reinterpret_cast<const char *>(p + 9);
+	return std::string(name, std::find(name, name + kk::STACK_NAME, '\0'));
+}
+
+// Columnar log, one file per record type
+class Log
+{
+public:
+	bool open(const std::string &dir)
+	{
+		mkdir(dir.c_str(), 0755);
+		control_.open(dir + "/control.csv");
+		link_.open(dir + "/link.csv");
+		loop_.open(dir + "/loop.csv");
+		event_.open(dir + "/event.csv");
+		profile_.open(dir + "/profile.csv");
+		memory_.open(dir + "/memory.csv");
+		stack_.open(dir + "/stack.csv");
+		if(!control_ || !link_ || !loop_ || !event_ || !profile_ || !memory_ || !stack_)
+			return false;
+
+		control_ << "source,time_us,seq,speed,direction,acked\n";
+		link_ << "source,time_us,seq,packets,acked,log_dropped\n";
+		loop_ << "source,time_us,seq,loop_us,loop_max_us\n";
+		event_ << "source,time_us,seq,event,arg\n";
+		profile_ << "source,time_us,seq,zone,clock_mhz,count,min_cycles,max_cycles,mean_cycles\n";
+		memory_ << "source,time_us,seq,static,heap_used,heap_reserved,stack_used,stack_reserved,free\n";
+		stack_ << "source,time_us,seq,task,name,stack_used,stack_reserved\n";
+		enabled_ = true;
+		return true;
+	}
+
+	void write(uint8_t source, uint64_t time, const kk::Frame &f)
+	{
+		if(!enabled_)
+			return;
+
+		const uint8_t *p = f.payload.data();
+		switch(f.type)
+		{
+		case kk::TYPE_CONTROL:
+			control_ << +source << ',' << time << ',' << +f.seq << ',' << +p[0] << ',' << +p[1] << ','
+				<< ((p[2] & kk::CONTROL_ACKED) ? 1 : 0) << '\n';
+			break;
+		case kk::TYPE_LINK:
+			link_ << +source << ',' << time << ',' << +f.seq << ',' << kk::get32(p) << ',' << kk::get32(p + 4) << ','
+				<< kk::get32(p + 8) << '\n';
+			break;
+		case kk::TYPE_LOOP:
+			loop_ << +source << ',' << time << ',' << +f.seq << ',' << kk::get32(p) << ',' << kk::get32(p + 4) << '\n';
+			break;
+		case kk::TYPE_EVENT:
+			event_ << +source << ',' << time << ',' << +f.seq << ',' << kk::eventName(p[0]) << ',' << kk::get32(p + 1) << '\n';
+			break;
+		case kk::TYPE_PROFILE:
+			profile_ << +source << ',' << time << ',' << +f.seq << ',' << kk::zoneName(p[0]) << ',' << +p[1] << ','
+				<< kk::get32(p + 2) << ',' << kk::get32(p + 6) << ',' << kk::get32(p + 10) << ',' << kk::get32(p + 14) << '\n';
+			break;
+		case kk::TYPE_MEMORY:
+			memory_ << +source << ',' << time << ',' << +f.seq << ',' << kk::get32(p) << ',' << kk::get32(p + 4) << ','
+				<< kk::get32(p + 8) << ',' << kk::get32(p + 12) << ',' << kk::get32(p + 16) << ',' << kk::get32(p + 20) << '\n';
+			break;
+		case kk::TYPE_STACK:
+			stack_ << +source << ',' << time << ',' << +f.seq << ',' << +p[0] << ',' << taskName(p) << ',' << kk::get32(p + 1)
+				<< ',' << kk::get32(p + 5) << '\n';
+			break;
+		}
+	}
+
+private:
+	bool enabled_ = false;
+	std::ofstream control_, link_, loop_, event_, profile_, memory_, stack_;
+};
+
+// Statistics of a single stream
+class Analyzer
+{
+public:
+	Analyzer(const std::string &name, Log &log, bool verbose) : name_(name), log_(log), verbose_(verbose) {}
+
+	void frame(const kk::Frame &f)
+	{
+		if(!validLength(f))
+		{
+			malformed_++;
+			return;
+		}
+
+		// Board reset - timestamps and sequence start from zero again
+		if(f.type == kk::TYPE_EVENT && f.payload[0] == kk::EVENT_BOOT)
+		{
+			source_ = static_cast<uint8_t>(kk::get32(&f.payload[1]));
+			boots_++;
+			timeline_.reset();
+			haveSeq_ = false;
+			haveControl_ = false;
+			lastControl_ = 0;
+		}
+
+		if(haveSeq_)
+			seqLost_ += static_cast<uint8_t>(f.seq - lastSeq_ - 1);
+		haveSeq_ = true;
+		lastSeq_ = f.seq;
+
+		uint64_t time = timeline_.extend(f.timestamp);
+		log_.write(source_, time, f);
+		if(verbose_)
+			print(time, f);
+
+		const uint8_t *p = f.payload.data();
+		switch(f.type)
+		{
+		case kk::TYPE_CONTROL:
+			controls_++;
+			if(p[2] & kk::CONTROL_ACKED)
+				acked_++;
+			// A control frame stamped before the previous one is reordering, not a gap
+			if(haveControl_ && time >= lastControl_)
+			{
+				uint64_t delta = time - lastControl_;
+				interArrival_.add(static_cast<uint32_t>(std::min<uint64_t>(delta, UINT32_MAX)));
+				histogram_[std::min<size_t>(delta / HIST_BUCKET_US, HIST_BUCKETS - 1)]++;
+			}
+			haveControl_ = true;
+			lastControl_ = std::max(lastControl_, time);
+			break;
+		case kk::TYPE_LINK:
+			linkPackets_ = kk::get32(p);
+			linkAcked_ = kk::get32(p + 4);
+			logDropped_ = kk::get32(p + 8);
+			break;
+		case kk::TYPE_LOOP:
+			loop_.add(kk::get32(p));
+			loopMax_ = std::max(loopMax_, kk::get32(p + 4));
+			break;
+		case kk::TYPE_EVENT:
+			events_[p[0]]++;
+			if(p[0] == kk::EVENT_LINK_UP)
+				outage_.add(kk::get32(p + 1));
+			break;
+		case kk::TYPE_PROFILE:
+			// Newest report per zone wins, accumulators on board are cumulative
+			profiles_[p[0]] = f.payload;
+			break;
+		case kk::TYPE_MEMORY:
+			memory_ = f.payload;
+			break;
+		case kk::TYPE_STACK:
+			stacks_[p[0]] = f.payload;
+			break;
+		}
+	}
+
+	void report(const kk::FrameDecoder &decoder)
+	{
+		std::printf("== %s (%s)\n", name_.c_str(),
+			source_ == kk::SOURCE_TX ? "Boat_TX" : source_ == kk::SOURCE_RX ? "Boat_RX" : "unknown board");
+		std::printf("bytes %llu, frames %llu, crc errors %llu, framing errors %llu, malformed %llu, boots %u\n",
+			ull(decoder.bytes()), ull(decoder.frames()), ull(decoder.crcErrors()), ull(decoder.framingErrors()),
+			ull(malformed_), boots_);
+		std::printf("stream: %llu frames missing by sequence, %llu stamped out of order, %u records dropped by logger\n",
+			ull(seqLost_), ull(timeline_.reordered()), logDropped_);
+
+		if(linkPackets_)
+			std::printf("radio: %u packets, %u acked, loss %.2f %%\n", linkPackets_, linkAcked_,
+				100.0 * (linkPackets_ - linkAcked_) / linkPackets_);
+
+		if(!interArrival_.values.empty())
+		{
+			uint32_t p50 = interArrival_.percentile(0.50);
+			std::printf("control: %llu frames, %.2f %% acked\n", ull(controls_), 100.0 * acked_ / controls_);
+			std::printf("inter-arrival us: p50 %u p90 %u p99 %u max %u (jitter p99-p50 %u)\n", p50,
+				interArrival_.percentile(0.90), interArrival_.percentile(0.99), interArrival_.max(),
+				interArrival_.percentile(0.99) - p50);
+			histogram();
+		}
+
+		if(!loop_.values.empty())
+			std::printf("loop us: p50 %u p90 %u p99 %u max %u (board max %u)\n", loop_.percentile(0.50),
+				loop_.percentile(0.90), loop_.percentile(0.99), loop_.max(), loopMax_);
+
+		if(!outage_.values.empty())
+			std::printf("link outages ms: count %zu p50 %u max %u\n", outage_.values.size(), outage_.percentile(0.50),
+				outage_.max());
+
+		for(const auto &e : events_)
+			std::printf("event %s: %llu\n", kk::eventName(e.first), ull(e.second));
+
+		if(!profiles_.empty())
+			profile();
+
+		if(!memory_.empty())
+			memory();
+
+		if(!stacks_.empty())
+			stacks();
+	}
+
+private:
+	static unsigned long long ull(uint64_t v) { return static_cast<unsigned long long>(v); }
+
+	static bool validLength(const kk::Frame &f)
+	{
+		switch(f.type)
+		{
+		case kk::TYPE_CONTROL:	return f.payload.size() == 3;
+		case kk::TYPE_LINK:		return f.payload.size() == 12;
+		case kk::TYPE_LOOP:		return f.payload.size() == 8;
+		case kk::TYPE_EVENT:	return f.payload.size() == 5;
+		case kk::TYPE_PROFILE:	return f.payload.size() == kk::PROFILE_SIZE;
+		case kk::TYPE_MEMORY:	return f.payload.size() == kk::MEMORY_SIZE;
+		case kk::TYPE_STACK:	return f.payload.size() == kk::STACK_SIZE;
+		default:				return false;
+		}
+	}
+
+	void print(uint64_t time, const kk::Frame &f)
+	{
+		const uint8_t *p = f.payload.data();
+		std::printf("%12.6f %3u ", time / 1e6, f.seq);
+		switch(f.type)
+		{
+		case kk::TYPE_CONTROL:
+			std::printf("control speed %u direction %u%s\n", p[0], p[1], (p[2] & kk::CONTROL_ACKED) ? " acked" : "");
+			break;
+		case kk::TYPE_LINK:
+			std::printf("link packets %u acked %u dropped %u\n", kk::get32(p), kk::get32(p + 4), kk::get32(p + 8));
+			break;
+		case kk::TYPE_LOOP:
+			std::printf("loop %u us max %u us\n", kk::get32(p), kk::get32(p + 4));
+			break;
+		case kk::TYPE_EVENT:
+			std::printf("event %s %u\n", kk::eventName(p[0]), kk::get32(p + 1));
+			break;
+		case kk::TYPE_PROFILE:
+			std::printf("profile %s count %u mean %u cycles\n", kk::zoneName(p[0]), kk::get32(p + 2), kk::get32(p + 14));
+			break;
+		case kk::TYPE_MEMORY:
+			std::printf("memory stack %u heap %u free %u bytes\n", kk::get32(p + 12), kk::get32(p + 4), kk::get32(p + 20));
+			break;
+		case kk::TYPE_STACK:
+			std::printf("stack %s %u of %u bytes\n", taskName(p).c_str(), kk::get32(p + 1), kk::get32(p + 5));
+			break;
+		}
+	}
+
+	// Newest RAM report against linker script reservations
+	void memory()
+	{
+		const uint8_t *p = memory_.data();
+		uint32_t stackUsed = kk::get32(p + 12);
+		uint32_t stackReserved = kk::get32(p + 16);
+
+		std::printf("ram bytes: static %u, heap %u of %u reserved, stack %u of %u reserved%s, never used %u\n",
+			kk::get32(p), kk::get32(p + 4), kk::get32(p + 8), stackUsed, stackReserved,
+			stackUsed > stackReserved ? " (OVER)" : "", kk::get32(p + 20));
+	}
+
+	// Newest high-water mark of every FreeRTOS task stack
+	void stacks()
+	{
+		std::printf("task stack bytes:\n");
+		for(const auto &s : stacks_)
+		{
+			const uint8_t *p = s.second.data();
+			uint32_t used = kk::get32(p + 1);
+			uint32_t reserved = kk::get32(p + 5);
+
+			std::printf("  %-16s %6u of %6u%s\n", taskName(p).c_str(), used, reserved,
+				used >= reserved ? " (FULL)" : "");
+		}
+	}
+
+	// Zone table in microseconds, histogram as power-of-two cycle buckets
+	void profile()
+	{
+		std::printf("%-16s %10s %10s %10s %10s  histogram from 2^%u cycles\n", "zone", "count", "min us", "mean us",
+			"max us", kk::PROFILE_BUCKET_SHIFT);
+		for(const auto &z : profiles_)
+		{
+			const uint8_t *p = z.second.data();
+			double mhz = p[1] ? p[1] : 1;
+			std::printf("%-16s %10u %10.2f %10.2f %10.2f ", kk::zoneName(z.first), kk::get32(p + 2),
+				kk::get32(p + 6) / mhz, kk::get32(p + 14) / mhz, kk::get32(p + 10) / mhz);
+			for(size_t b = 0; b < kk::PROFILE_BUCKETS; b++)
+				std::printf(" %u", p[18 + 2 * b] | (p[19 + 2 * b] << 8));
+			std::printf("\n");
+		}
+	}
+
+	void histogram()
+	{
+		uint64_t peak = *std::max_element(histogram_, histogram_ + HIST_BUCKETS);
+		for(size_t i = 0; i < HIST_BUCKETS; i++)
+		{
+			if(!histogram_[i])
+				continue;
+			int bar = static_cast<int>(40 * histogram_[i] / peak);
+			std::printf("  %3zu%s ms %8llu %.*s\n", i * HIST_BUCKET_US / 1000, i == HIST_BUCKETS - 1 ? "+" : " ",
+				ull(histogram_[i]), bar, "########################################");
+		}
+	}
+
+	std::string name_;
+	Log &log_;
+	bool verbose_;
+
+	uint8_t source_ = 0;
+	unsigned boots_ = 0;
+	kk::Timeline timeline_;
+	bool haveSeq_ = false;
+	uint8_t lastSeq_ = 0;
+	uint64_t seqLost_ = 0;
+	uint64_t malformed_ = 0;
+
+	uint64_t controls_ = 0;
+	uint64_t acked_ = 0;
+	bool haveControl_ = false;
+	uint64_t lastControl_ = 0;
+	Samples interArrival_;
+	uint64_t histogram_[HIST_BUCKETS] = {};
+
+	uint32_t linkPackets_ = 0;
+	uint32_t linkAcked_ = 0;
+	uint32_t logDropped_ = 0;
+
+	Samples loop_;
+	uint32_t loopMax_ = 0;
+	Samples outage_;
+	std::map<uint8_t, uint64_t> events_;
+	std::map<uint8_t, std::vector<uint8_t>> profiles_;
+	std::vector<uint8_t> memory_;
+	std::map<uint8_t, std::vector<uint8_t>> stacks_;
+};
+
+void usage()
+{
+	std::fprintf(stderr, "usage: kk_telemetry [-b baud] [-w raw.bin] [-o logdir] [-v] <input>...\n");
+	std::exit(2);
+}
+
+Options parse(int argc, char **argv)
+{
+	Options opt;
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if((arg == "-b" || arg == "-w" || arg == "-o") && i + 1 >= argc)
+			usage();
+
+		if(arg == "-b")
+			opt.baudrate = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+		else if(arg == "-w")
+			opt.rawPath = argv[++i];
+		else if(arg == "-o")
+			opt.logDir = argv[++i];
+		else if(arg == "-v")
+			opt.verbose = true;
+		else if(arg.size() > 1 && arg[0] == '-')
+			usage();
+		else
+			opt.inputs.push_back(arg);
+	}
+
+	if(opt.inputs.empty() || (!opt.rawPath.empty() && opt.inputs.size() != 1))
+		usage();
+	return opt;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options opt = parse(argc, argv);
+
+	// No SA_RESTART - Ctrl+C interrupts the blocking read and ends the capture
+	struct sigaction sa{};
+	sa.sa_handler = [](int) {};
+	sigaction(SIGINT, &sa, nullptr);
+	sigaction(SIGTERM, &sa, nullptr);
+
+	Log log;
+	if(!opt.logDir.empty() && !log.open(opt.logDir))
+	{
+		std::fprintf(stderr, "kk_telemetry: cannot write log to %s\n", opt.logDir.c_str());
+		return 1;
+	}
+
+	int status = 0;
+	for(const std::string &path : opt.inputs)
+	{
+		kk::Input input;
+		if(!input.open(path, opt.baudrate))
+		{
+			std::fprintf(stderr, "kk_telemetry: %s\n", input.error().c_str());
+			status = 1;
+			continue;
+		}
+
+		std::ofstream raw;
+		if(!opt.rawPath.empty())
+			raw.open(opt.rawPath, std::ios::binary);
+
+		kk::FrameDecoder decoder;
+		Analyzer analyzer(path, log, opt.verbose);
+		std::vector<kk::Frame> frames;
+		uint8_t buffer[4096];
+
+		long n;
+		while((n = input.read(buffer, sizeof(buffer))) > 0)
+		{
+			if(raw.is_open())
+				raw.write(reinterpret_cast<const char *>(buffer), n);
+
+			frames.clear();
+			decoder.feed(buffer, static_cast<size_t>(n), frames);
+			for(const kk::Frame &f : frames)
+				analyzer.frame(f);
+		}
+		if(n < 0)
+		{
+			std::fprintf(stderr, "kk_telemetry: %s: %s\n", path.c_str(), input.error().c_str());
+			status = 1;
+		}
+
+		analyzer.report(decoder);
+	}
+	return status;
+}
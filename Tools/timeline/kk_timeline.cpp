@@ -0,0 +1,459 @@
+/*
+Program for:				Exporting KK_TRACE captures to Chrome / Perfetto timeline
+Written by:					Kacper Kupiszewski & Wojciech Czechowski
+Based on:					- Trace Event Format (Chrome tracing, loaded by ui.perfetto.dev)
+							- Boat_TX/Inc/KK_TRACE.h
+First update:				18/10/2026
+Last update:				18/10/2026
+*/
+
+/*
+Usage:	kk_timeline [options] -o trace.json [-t tx.swo] [-r rx.swo]
+
+		-t <capture>	Boat_TX SWO capture (see kk_swo)
+		-r <capture>	Boat_RX SWO capture
+		-o <file>		Chrome trace-event JSON, open in ui.perfetto.dev or chrome://tracing
+		-c <MHz>		core clock of both boards at boot (default 84), CLOCK events switch it
+		-l <us>			assumed minimum radio latency when aligning clocks (default 300)
+
+Board clocks are unrelated (HSI, up to 1 % apart), so RX is mapped onto the TX time axis with a
+linear fit over radio packets seen on both sides. The packet sequence byte is the sync marker:
+RADIO_TX and RADIO_RX carry speed, direction and sequence, and are linked with flow arrows.
+*/
+
+#include "kk_input.h"
+#include "kk_itm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Track ids inside each board process
+enum Track
+{
+	TRACK_MAIN = 1,
+	TRACK_SPI,
+	TRACK_I2C,
+	TRACK_IRQ,
+	TRACK_RADIO,
+};
+
+// Sequence byte wraps every 256 packets (25.6 s at 100 ms), windows must stay well below
+constexpr double LOCK_WINDOW_US = 50e3;
+constexpr double MATCH_WINDOW_US = 1e6;
+
+struct Options
+{
+	std::string txPath;
+	std::string rxPath;
+	std::string outPath;
+	double mhz = 84.0;
+	double minLatency = 300.0;
+};
+
+struct Event
+{
+	double us;							// local board time
+	uint8_t event;
+	uint32_t arg;
+};
+
+// Linear map from RX local time to TX time axis
+struct ClockMap
+{
+	double scale = 1.0;
+	double offset = 0.0;
+
+	double toTx(double rx) const { return (rx - offset) / scale; }
+};
+
+void usage()
+{
+	std::fprintf(stderr, "usage: kk_timeline [-c MHz] [-l us] -o trace.json [-t tx.swo] [-r rx.swo]\n");
+	std::exit(2);
+}
+
+Options parse(int argc, char **argv)
+{
+	Options opt;
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if(i + 1 >= argc)
+			usage();
+
+		if(arg == "-t")
+			opt.txPath = argv[++i];
+		else if(arg == "-r")
+			opt.rxPath = argv[++i];
+		else if(arg == "-o")
+			opt.outPath = argv[++i];
+		else if(arg == "-c")
+			opt.mhz = std::strtod(argv[++i], nullptr);
+		else if(arg == "-l")
+			opt.minLatency = std::strtod(argv[++i], nullptr);
+		else
+			usage();
+	}
+
+	if(opt.outPath.empty() || (opt.txPath.empty() && opt.rxPath.empty()) || opt.mhz <= 0)
+		usage();
+	return opt;
+}
+
+bool load(const std::string &path, double mhz, std::vector<Event> &events)
+{
+	kk::Input input;
+	if(!input.open(path))
+	{
+		std::fprintf(stderr, "kk_timeline: %s\n", input.error().c_str());
+		return false;
+	}
+
+	kk::ItmDecoder itm;
+	kk::TraceDecoder trace(mhz);
+	std::vector<kk::ItmPacket> packets;
+	std::vector<kk::TraceEvent> decoded;
+	uint8_t buffer[4096];
+
+	long n;
+	while((n = input.read(buffer, sizeof(buffer))) > 0)
+	{
+		packets.clear();
+		decoded.clear();
+		itm.feed(buffer, static_cast<size_t>(n), packets);
+		trace.feed(packets, decoded);
+		for(const kk::TraceEvent &e : decoded)
+			events.push_back({ e.us, e.event, e.arg });
+	}
+	if(n < 0)
+	{
+		std::fprintf(stderr, "kk_timeline: %s: %s\n", path.c_str(), input.error().c_str());
+		return false;
+	}
+
+	std::fprintf(stderr, "%s: %zu events, %llu ITM overflows\n", path.c_str(), events.size(),
+		static_cast<unsigned long long>(itm.overflows()));
+	return true;
+}
+
+// Pair RADIO_TX and RADIO_RX with equal payload, returns (tx time, rx time)
+std::vector<std::pair<double, double>> matchPackets(const std::vector<Event> &tx, const std::vector<Event> &rx)
+{
+	std::multimap<uint32_t, double> sent;
+	std::vector<const Event *> received;
+	for(const Event &e : tx)
+		if(e.event == kk::TRACE_RADIO_TX)
+			sent.emplace(e.arg, e.us);
+	for(const Event &e : rx)
+		if(e.event == kk::TRACE_RADIO_RX)
+			received.push_back(&e);
+
+	// Sent packet closest to expected time, or nullptr when none is inside window
+	auto closest = [&](const Event &e, double offset, double window) -> const double * {
+		const double *best = nullptr;
+		auto range = sent.equal_range(e.arg);
+		for(auto it = range.first; it != range.second; ++it)
+		{
+			double error = std::fabs(e.us - it->second - offset);
+			if(error < window)
+			{
+				window = error;
+				best = &it->second;
+			}
+		}
+		return best;
+	};
+
+	// Lock: try every candidate of an early packet, keep offset most following packets agree with
+	double offset = 0.0;
+	size_t bestVotes = 0;
+	for(size_t i = 0; i < received.size() && i < 8; i++)
+	{
+		auto range = sent.equal_range(received[i]->arg);
+		for(auto it = range.first; it != range.second; ++it)
+		{
+			double candidate = received[i]->us - it->second;
+			size_t votes = 0;
+			for(size_t j = i; j < received.size() && j < i + 32; j++)
+				if(closest(*received[j], candidate, LOCK_WINDOW_US))
+					votes++;
+			if(votes > bestVotes)
+			{
+				bestVotes = votes;
+				offset = candidate;
+			}
+		}
+	}
+
+	std::vector<std::pair<double, double>> pairs;
+	if(bestVotes == 0)
+		return pairs;
+
+	// Track: offset follows clock drift from packet to packet
+	for(const Event *e : received)
+	{
+		const double *match = closest(*e, offset, MATCH_WINDOW_US);
+		if(!match)
+			continue;
+		offset = e->us - *match;
+		pairs.emplace_back(*match, e->us);
+	}
+	return pairs;
+}
+
+// Least squares rx = scale * tx + offset, then shift so fastest packet took minLatency
+ClockMap fitClock(const std::vector<std::pair<double, double>> &pairs, double minLatency)
+{
+	ClockMap map;
+	if(pairs.empty())
+		return map;
+
+	double n = static_cast<double>(pairs.size());
+	double sx = 0, sy = 0, sxx = 0, sxy = 0;
+	for(const auto &p : pairs)
+	{
+		sx += p.first;
+		sy += p.second;
+	}
+	double mx = sx / n, my = sy / n;
+	for(const auto &p : pairs)
+	{
+		sxx += (p.first - mx) * (p.first - mx);
+		sxy += (p.first - mx) * (p.second - my);
+	}
+	if(pairs.size() > 1 && sxx > 0)
+		map.scale = sxy / sxx;
+	map.offset = my - map.scale * mx;
+
+	double minResidual = INFINITY;
+	for(const auto &p : pairs)
+		minResidual = std::min(minResidual, p.second - (map.scale * p.first + map.offset));
+	map.offset += minResidual - minLatency * map.scale;
+	return map;
+}
+
+// Flow ids of sent packets: payload -> send time on TX axis -> id
+typedef std::map<uint32_t, std::map<double, uint64_t>> Flows;
+
+class Writer
+{
+public:
+	explicit Writer(std::ofstream &out) : out_(out) { out_ << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"; }
+
+	~Writer() { out_ << "\n]}\n"; }
+
+	void meta(int pid, int tid, const char *kind, const char *name)
+	{
+		begin();
+		out_ << "{\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"name\":\"" << kind
+			<< "\",\"args\":{\"name\":\"" << name << "\"}}";
+	}
+
+	void span(char ph, int pid, int tid, double ts, const std::string &name, const std::string &args = "")
+	{
+		begin();
+		out_ << "{\"ph\":\"" << ph << "\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":" << fixed(ts)
+			<< ",\"name\":\"" << name << "\"";
+		if(ph == 'i')
+			out_ << ",\"s\":\"t\"";
+		if(!args.empty())
+			out_ << ",\"args\":{" << args << "}";
+		out_ << "}";
+	}
+
+	void flow(char ph, int pid, int tid, double ts, uint64_t id)
+	{
+		begin();
+		out_ << "{\"ph\":\"" << ph << "\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":" << fixed(ts)
+			<< ",\"name\":\"packet\",\"cat\":\"radio\",\"id\":" << id;
+		if(ph == 'f')
+			out_ << ",\"bp\":\"e\"";
+		out_ << "}";
+	}
+
+private:
+	void begin()
+	{
+		if(!first_)
+			out_ << ",\n";
+		first_ = false;
+	}
+
+	static std::string fixed(double us)
+	{
+		char buf[32];
+		std::snprintf(buf, sizeof(buf), "%.3f", us);
+		return buf;
+	}
+
+	std::ofstream &out_;
+	bool first_ = true;
+};
+
+std::string radioArgs(uint32_t arg)
+{
+	return "\"speed\":" + std::to_string((arg >> 16) & 0xFF) + ",\"direction\":" + std::to_string((arg >> 8) & 0xFF) +
+		",\"sequence\":" + std::to_string(arg & 0xFF);
+}
+
+// Emit one board, times mapped through clock (identity for TX)
+void emit(Writer &w, int pid, const char *name, const std::vector<Event> &events, const ClockMap &clock,
+	Flows &flows, bool sender)
+{
+	w.meta(pid, 0, "process_name", name);
+	w.meta(pid, TRACK_MAIN, "thread_name", "main loop");
+	w.meta(pid, TRACK_SPI, "thread_name", "SPI2 nRF24");
+	w.meta(pid, TRACK_I2C, "thread_name", "I2C1 LCD");
+	w.meta(pid, TRACK_IRQ, "thread_name", "interrupts");
+	w.meta(pid, TRACK_RADIO, "thread_name", "radio");
+
+	// Open spans are closed in order, unmatched ends (capture started mid-span) are skipped
+	std::vector<uint32_t> irqOpen;
+	std::vector<uint32_t> taskOpen;
+	bool spiOpen = false, i2cOpen = false, radioOpen = false, failsafeOpen = false;
+	uint64_t nextFlow = 1;
+
+	for(const Event &e : events)
+	{
+		double ts = clock.toTx(e.us);
+		switch(e.event)
+		{
+		case kk::TRACE_SYNC:
+			w.span('i', pid, TRACK_MAIN, ts, "boot");
+			break;
+		case kk::TRACE_CLOCK:
+			w.span('i', pid, TRACK_MAIN, ts, "clock", "\"mhz\":" + std::to_string(e.arg));
+			break;
+		case kk::TRACE_TASK_START:
+			taskOpen.push_back(e.arg);
+			w.span('B', pid, TRACK_MAIN, ts, kk::zoneName(static_cast<uint8_t>(e.arg)));
+			break;
+		case kk::TRACE_TASK_STOP:
+			if(!taskOpen.empty() && taskOpen.back() == e.arg)
+			{
+				taskOpen.pop_back();
+				w.span('E', pid, TRACK_MAIN, ts, kk::zoneName(static_cast<uint8_t>(e.arg)));
+			}
+			break;
+		case kk::TRACE_IRQ_ENTER:
+			irqOpen.push_back(e.arg);
+			w.span('B', pid, TRACK_IRQ, ts, kk::irqName(e.arg));
+			break;
+		case kk::TRACE_IRQ_EXIT:
+			if(!irqOpen.empty() && irqOpen.back() == e.arg)
+			{
+				irqOpen.pop_back();
+				w.span('E', pid, TRACK_IRQ, ts, kk::irqName(e.arg));
+			}
+			break;
+		case kk::TRACE_SPI_BEGIN:
+			spiOpen = true;
+			w.span('B', pid, TRACK_SPI, ts, "spi");
+			break;
+		case kk::TRACE_SPI_END:
+			if(spiOpen)
+				w.span('E', pid, TRACK_SPI, ts, "spi");
+			spiOpen = false;
+			break;
+		case kk::TRACE_I2C_BEGIN:
+			i2cOpen = true;
+			w.span('B', pid, TRACK_I2C, ts, "lcd frame", "\"bytes\":" + std::to_string(e.arg));
+			break;
+		case kk::TRACE_I2C_END:
+			if(i2cOpen)
+				w.span('E', pid, TRACK_I2C, ts, "lcd frame", e.arg ? "" : "\"error\":1");
+			i2cOpen = false;
+			break;
+		case kk::TRACE_RADIO_TX:
+			radioOpen = true;
+			w.span('B', pid, TRACK_RADIO, ts, "radio tx", radioArgs(e.arg));
+			if(sender)
+			{
+				flows[e.arg][ts] = nextFlow;
+				w.flow('s', pid, TRACK_RADIO, ts, nextFlow++);
+			}
+			break;
+		case kk::TRACE_RADIO_TX_DONE:
+			if(radioOpen)
+				w.span('E', pid, TRACK_RADIO, ts, "radio tx", e.arg ? "" : "\"lost\":1");
+			radioOpen = false;
+			break;
+		case kk::TRACE_RADIO_RX:
+			w.span('i', pid, TRACK_RADIO, ts, "radio rx", radioArgs(e.arg));
+			if(!sender && flows.count(e.arg))
+			{
+				// Sequence wraps, so link to the latest send of this payload before reception
+				auto &sends = flows[e.arg];
+				auto it = sends.upper_bound(ts);
+				if(it != sends.begin())
+				{
+					--it;
+					w.flow('f', pid, TRACK_RADIO, ts, it->second);
+					sends.erase(it);
+				}
+			}
+			break;
+		case kk::TRACE_FAILSAFE_ENTER:
+			failsafeOpen = true;
+			w.span('B', pid, TRACK_RADIO, ts, "failsafe", "\"silent_ms\":" + std::to_string(e.arg));
+			break;
+		case kk::TRACE_FAILSAFE_EXIT:
+			if(failsafeOpen)
+				w.span('E', pid, TRACK_RADIO, ts, "failsafe");
+			failsafeOpen = false;
+			break;
+		}
+	}
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options opt = parse(argc, argv);
+
+	std::vector<Event> tx, rx;
+	if(!opt.txPath.empty() && !load(opt.txPath, opt.mhz, tx))
+		return 1;
+	if(!opt.rxPath.empty() && !load(opt.rxPath, opt.mhz, rx))
+		return 1;
+
+	ClockMap rxClock;
+	if(!tx.empty() && !rx.empty())
+	{
+		auto pairs = matchPackets(tx, rx);
+		if(pairs.empty())
+		{
+			std::fprintf(stderr, "kk_timeline: no radio packet seen by both boards, RX left on its own clock\n");
+		}
+		else
+		{
+			rxClock = fitClock(pairs, opt.minLatency);
+			std::fprintf(stderr, "aligned on %zu packets: RX clock %+.0f ppm, offset %.3f ms\n", pairs.size(),
+				(rxClock.scale - 1.0) * 1e6, rxClock.offset / 1000.0);
+		}
+	}
+
+	std::ofstream out(opt.outPath);
+	if(!out)
+	{
+		std::fprintf(stderr, "kk_timeline: cannot write %s\n", opt.outPath.c_str());
+		return 1;
+	}
+
+	{
+		Writer w(out);
+		Flows flows;
+		emit(w, kk::SOURCE_TX, "Boat_TX", tx, ClockMap(), flows, true);
+		emit(w, kk::SOURCE_RX, "Boat_RX", rx, rxClock, flows, false);
+	}
+	return out ? 0 : 1;
+}